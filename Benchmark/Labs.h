@@ -0,0 +1,87 @@
+#ifndef LABS_H_INCLUDED
+#define LABS_H_INCLUDED
+
+#include "Registry.h"
+#include "../Lab1/Sorting/Sorting.h"
+#include "../Lab2/Heapsort/Heapsort.h"
+#include "../Lab3/Quicksort/Quicksort.h"
+
+/** The algorithms of the labs that sort (or select from) an array of n ints, registered under
+    sort/, heap/ and quick/. the definitions are the ones the labs build, see their headers
+
+    Lab4 - Lab10 are not here: they count into a global int and keep their lists, tables,
+    trees and graphs in globals, so they can not run on the threads of the runner, and their
+    inputs are k lists, fill factors or graphs rather than an array of n ints
+*/
+
+inline void RegisterSorting(Registry &registry)
+{
+    REGISTER_ALGORITHM(registry, "sort/selection", selectSort, SizeRange(100, 10000, 100));
+    REGISTER_ALGORITHM(registry, "sort/insertion", insertionSort, SizeRange(100, 10000, 100));
+    REGISTER_ALGORITHM(registry, "sort/binary_insertion", BinsertionSort, SizeRange(100, 10000, 100));
+    REGISTER_ALGORITHM(registry, "sort/bubble", bubbleSort, SizeRange(100, 10000, 100));
+}
+
+inline void RegisterHeapsort(Registry &registry)
+{
+    REGISTER_ALGORITHM(registry, "heap/build_bottom_up", build_max_heap_bottom_up, SizeRange(100, 10000, 100));
+    REGISTER_ALGORITHM(registry, "heap/build_top_down", build_max_heap_top_down, SizeRange(100, 10000, 100));
+    REGISTER_ALGORITHM(registry, "heap/sort", heapsort, SizeRange(100, 10000, 100));
+}
+
+/** the quick sort of Lab3 on the threads of the runner: the same partitions, but it recurses on the
+    smaller side and loops on the other, so that sorted inputs of any size stay within the stack of a
+    worker thread (the lab's own quicksort keeps its two calls, see its call tree)
+*/
+template <typename Counter>
+void quicksortBounded(int a[], int (*part_func)(int*, int, int, Counter&), int l, int r, Counter &c)
+{
+    while(l < r)
+    {
+        int pivotIndex = part_func(a, l, r, c);
+        if(pivotIndex - l < r - pivotIndex)
+        {
+            quicksortBounded(a, part_func, l, pivotIndex - 1, c);
+            l = pivotIndex + 1;
+        }
+        else
+        {
+            quicksortBounded(a, part_func, pivotIndex + 1, r, c);
+            r = pivotIndex - 1;
+        }
+    }
+}
+
+template <typename Counter>
+void quicksortLast(int a[], int n, Counter &c)
+{
+    quicksortBounded(a, part<int, Counter>, 0, n - 1, c);
+}
+
+template <typename Counter>
+void quicksortMiddle(int a[], int n, Counter &c)
+{
+    quicksortBounded(a, part_m<int, Counter>, 0, n - 1, c);
+}
+
+template <typename Counter>
+void quicksortRandom(int a[], int n, Counter &c)
+{
+    quicksortBounded(a, part_rand<int, Counter>, 0, n - 1, c);
+}
+
+template <typename Counter>
+void quickselectMedian(int a[], int n, Counter &c)
+{
+    quickselect(a, 0, n - 1, (n + 1) / 2, c);
+}
+
+inline void RegisterQuicksort(Registry &registry)
+{
+    REGISTER_ALGORITHM(registry, "quick/sort_last", quicksortLast, SizeRange(100, 10000, 100));
+    REGISTER_ALGORITHM(registry, "quick/sort_middle", quicksortMiddle, SizeRange(100, 10000, 100));
+    REGISTER_ALGORITHM(registry, "quick/sort_random", quicksortRandom, SizeRange(100, 10000, 100));
+    REGISTER_ALGORITHM(registry, "quick/select_median", quickselectMedian, SizeRange(100, 10000, 100));
+}
+
+#endif // LABS_H_INCLUDED
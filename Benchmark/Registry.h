@@ -0,0 +1,198 @@
+#ifndef _REGISTRY_H
+#define _REGISTRY_H
+
+#include "SweepRunner.h"
+
+/**
+* the algorithms, inputs and size ranges a benchmark driver can choose from.
+* an algorithm is a function template over the counter policy, registered once:
+*
+*	REGISTER_ALGORITHM(registry, "sort/bubble", bubbleSort, SizeRange(100, 10000, 100));
+*
+* which keeps an OpCounter instance (to count) and a NullCounter one (to time).
+* algorithms and inputs are selected by comma separated glob patterns ("quick/sort_*,heap/?ort")
+*/
+struct SizeRange{
+	int minSize, maxSize, step;
+	//geometric when above 1, step is not used then
+	double factor;
+
+	SizeRange(int min = 100, int max = 10000, int stepSize = 100)
+		: minSize(min), maxSize(max), step(stepSize), factor(0.0) {}
+
+	static SizeRange geometric(int min, int max, double growth){
+		SizeRange range(min, max, 0);
+		range.factor = growth;
+		return range;
+	}
+
+	std::vector<int> sizes() const{
+		return factor > 1.0? GeometricSizes(minSize, maxSize, factor): LinearSizes(minSize, maxSize, step);
+	}
+
+	/**
+	* reads "min:max:step" or "min:max:xfactor" (e.g. 100:10000:100, 1000:10000000:x2);
+	* returns false if text is neither
+	*/
+	bool parse(const char *text){
+		int min, max, consumed = 0;
+		if(sscanf(text, "%d:%d:%n", &min, &max, &consumed) != 2 || consumed == 0 || min < 0 || max < min){
+			return false;
+		}
+		const char *rest = text + consumed;
+		char *end;
+		if(*rest == 'x' || *rest == '*'){
+			double growth = strtod(rest + 1, &end);
+			if(*end != '\0' || growth <= 1.0){
+				return false;
+			}
+			*this = geometric(min, max, growth);
+		}else{
+			long stepSize = strtol(rest, &end, 10);
+			if(*end != '\0' || stepSize <= 0){
+				return false;
+			}
+			*this = SizeRange(min, max, (int)stepSize);
+		}
+		return true;
+	}
+};
+
+struct AlgorithmEntry{
+	std::string name;
+	std::function<void(int*, int, OpCounter&)> counted;
+	std::function<void(int*, int)> plain;
+	SizeRange sizes;
+};
+
+struct InputEntry{
+	std::string name;
+	std::function<void(int*, int)> generate;
+};
+
+/**
+* glob matching of a whole name: * is any run of characters, ? is one character
+*/
+inline bool GlobMatch(const char *pattern, const char *text){
+	const char *star = NULL, *resume = NULL;
+	while(*text){
+		if(*pattern == '*'){
+			star = pattern++;
+			resume = text;
+		}else if(*pattern == '?' || *pattern == *text){
+			++pattern;
+			++text;
+		}else if(star){
+			pattern = star + 1;
+			text = ++resume;
+		}else{
+			return false;
+		}
+	}
+	while(*pattern == '*'){
+		++pattern;
+	}
+	return *pattern == '\0';
+}
+
+/**
+* true if name matches one of the comma separated patterns
+*/
+inline bool GlobMatchAny(const std::string &patterns, const std::string &name){
+	size_t start = 0;
+	while(start <= patterns.size()){
+		size_t end = patterns.find(',', start);
+		if(end == std::string::npos){
+			end = patterns.size();
+		}
+		if(GlobMatch(patterns.substr(start, end - start).c_str(), name.c_str())){
+			return true;
+		}
+		start = end + 1;
+	}
+	return false;
+}
+
+class Registry{
+public:
+	/**
+	* the registry of the program
+	*/
+	static Registry &instance(){
+		static Registry registry;
+		return registry;
+	}
+
+	void addAlgorithm(const char *name, std::function<void(int*, int, OpCounter&)> counted,
+			std::function<void(int*, int)> plain, const SizeRange &sizes = SizeRange()){
+		AlgorithmEntry entry;
+		entry.name = name;
+		entry.counted = counted;
+		entry.plain = plain;
+		entry.sizes = sizes;
+		algorithmList.push_back(entry);
+	}
+
+	void addInput(const char *name, std::function<void(int*, int)> generate){
+		InputEntry entry;
+		entry.name = name;
+		entry.generate = generate;
+		inputList.push_back(entry);
+	}
+
+	const std::vector<AlgorithmEntry> &algorithms() const { return algorithmList; }
+	const std::vector<InputEntry> &inputs() const { return inputList; }
+
+	/**
+	* the algorithms matching patterns, in the order they were registered
+	*/
+	std::vector<const AlgorithmEntry*> algorithms(const std::string &patterns) const{
+		std::vector<const AlgorithmEntry*> matches;
+		for(size_t i=0; i<algorithmList.size(); ++i){
+			if(GlobMatchAny(patterns, algorithmList[i].name)){
+				matches.push_back(&algorithmList[i]);
+			}
+		}
+		return matches;
+	}
+
+	std::vector<const InputEntry*> inputs(const std::string &patterns) const{
+		std::vector<const InputEntry*> matches;
+		for(size_t i=0; i<inputList.size(); ++i){
+			if(GlobMatchAny(patterns, inputList[i].name)){
+				matches.push_back(&inputList[i]);
+			}
+		}
+		return matches;
+	}
+
+private:
+	std::vector<AlgorithmEntry> algorithmList;
+	std::vector<InputEntry> inputList;
+};
+
+/**
+* registers function<Counter>(int *a, int n, Counter &c) under name
+*/
+#define REGISTER_ALGORITHM(registry, name, function, sizes) \
+	(registry).addAlgorithm(name, \
+		[](int *a, int n, OpCounter &c) { function(a, n, c); }, \
+		[](int *a, int n) { NullCounter c; function(a, n, c); }, \
+		sizes)
+
+/**
+* the input shapes of FillRandomArray (values from 0 to 50000), as random, ascending,
+* descending, nearly_sorted, few_unique, organ_pipe, sawtooth, zipf and all_equal
+*/
+inline void RegisterInputs(Registry &registry){
+	static const char *names[] = { "random", "ascending", "descending", "nearly_sorted", "few_unique",
+		"organ_pipe", "sawtooth", "zipf", "all_equal" };
+	static const SortMethod methods[] = { UNSORTED, ASCENDING, DESCENDING, NEARLY_SORTED, FEW_UNIQUE,
+		ORGAN_PIPE, SAWTOOTH, ZIPF, ALL_EQUAL };
+	for(size_t i=0; i<sizeof(names)/sizeof(names[0]); ++i){
+		SortMethod method = methods[i];
+		registry.addInput(names[i], [method](int *a, int n) { FillRandomArray(a, n, 0, 50000, false, method); });
+	}
+}
+
+#endif
@@ -0,0 +1,588 @@
+#ifndef _SWEEP_RUNNER_H
+#define _SWEEP_RUNNER_H
+
+#include "Profiler.h"
+
+#if defined(__linux__)
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+#include <deque>
+#include <exception>
+#include <new>
+#include <type_traits>
+
+/**
+* the sizes from minSize to maxSize (inclusive), step apart
+*/
+inline std::vector<int> LinearSizes(int minSize, int maxSize, int step){
+	std::vector<int> sizes;
+	for(int size = minSize; size <= maxSize && step > 0; size += step){
+		sizes.push_back(size);
+	}
+	return sizes;
+}
+
+/**
+* the sizes from minSize to maxSize (inclusive), each factor times the previous one
+* (rounded, and never the same size twice)
+*/
+inline std::vector<int> GeometricSizes(int minSize, int maxSize, double factor){
+	std::vector<int> sizes;
+	if(minSize < 1 || factor <= 1.0){
+		return sizes;
+	}
+	for(double size = minSize; size <= maxSize + 0.5; size *= factor){
+		int rounded = (int)(size + 0.5);
+		if(sizes.empty() || rounded > sizes.back()){
+			sizes.push_back(rounded);
+		}
+	}
+	return sizes;
+}
+
+/**
+* when runRefined adds sizes between two measured ones: the cost per element of the two
+* differs by more than threshold (0.1 = 10%), and the larger is at least minRatio times
+* the smaller. at most maxSizes sizes are added in all
+*/
+struct RefineRule{
+	double threshold;
+	double minRatio;
+	int maxSizes;
+
+	RefineRule() : threshold(0.1), minRatio(1.05), maxSizes(32) {}
+};
+
+/**
+* how SweepRunner prepares the measurements (see SweepRunner::configure). pinned workers
+* stay on one core each, with its caches and the page tables of its buffer; prefaulted
+* buffers have every page mapped before the first cell, so no cell pays for the first
+* touch; warmup is the number of untimed runs of every cell of runAdaptive and runRefined;
+* huge pages (2 MiB) take the input buffers out of the TLB misses of large sizes
+*/
+struct HarnessOptions{
+	bool pinThreads;
+	bool prefault;
+	int warmup;
+	bool hugePages;
+
+	HarnessOptions() : pinThreads(false), prefault(false), warmup(1), hugePages(false) {}
+};
+
+/**
+* the cpus the process may run on (all of them where that can not be asked)
+*/
+inline std::vector<int> AvailableCpus(){
+	std::vector<int> cpus;
+#if defined(__linux__)
+	cpu_set_t set;
+	if(sched_getaffinity(0, sizeof(set), &set) == 0){
+		for(int cpu=0; cpu<CPU_SETSIZE; ++cpu){
+			if(CPU_ISSET(cpu, &set)){
+				cpus.push_back(cpu);
+			}
+		}
+	}
+#endif
+	if(cpus.empty()){
+		int count = (int)std::thread::hardware_concurrency();
+		for(int cpu=0; cpu<(count > 0? count: 1); ++cpu){
+			cpus.push_back(cpu);
+		}
+	}
+	return cpus;
+}
+
+/**
+* pins the calling thread to cpu while it lives, then lets it run where it could before.
+* a negative cpu leaves the thread alone; pinned() is false then, and where the platform
+* (or the cpu) does not allow it
+*/
+class ThreadPin{
+public:
+	explicit ThreadPin(int cpu) : isPinned(false){
+		if(cpu < 0){
+			return;
+		}
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		isPinned = pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) == 0 &&
+			pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_MSC_VER)
+		previous = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+		isPinned = previous != 0;
+#else
+		(void)cpu;
+#endif
+	}
+
+	~ThreadPin(){
+		if(!isPinned){
+			return;
+		}
+#if defined(__linux__)
+		pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+#elif defined(_MSC_VER)
+		SetThreadAffinityMask(GetCurrentThread(), previous);
+#endif
+	}
+
+	bool pinned() const { return isPinned; }
+
+private:
+	bool isPinned;
+#if defined(__linux__)
+	cpu_set_t previous;
+#elif defined(_MSC_VER)
+	DWORD_PTR previous;
+#endif
+
+	ThreadPin(const ThreadPin&);
+	ThreadPin &operator=(const ThreadPin&);
+};
+
+/**
+* the input array of a worker. allocate only reserves the memory, so that the worker (on
+* its own core, and its own NUMA node) is the one that touches it first: prefault writes
+* every page, construct makes the elements. with huge pages it asks for hugetlbfs pages,
+* then for transparent ones (2 MiB aligned, with madvise), then takes normal pages
+*/
+template <typename T>
+class InputBuffer{
+public:
+	static const size_t HUGE_PAGE = 2 << 20;
+	static const size_t PAGE = 4096;
+
+	InputBuffer() : data(NULL), count(0), block(NULL), blockLength(0), mapped(false), constructed(false) {}
+
+	~InputBuffer(){
+		release();
+	}
+
+	/**
+	* reserves count elements (at least one); returns the kind of pages
+	* they got: "hugetlb", "transparent" or "normal"
+	*/
+	const char *allocate(size_t elements, bool hugePages){
+		release();
+		count = elements > 0? elements: 1;
+		size_t bytes = count * sizeof(T);
+		const char *pages = "normal";
+#if defined(__linux__)
+		if(hugePages){
+			size_t length = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+			void *memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+			memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if(memory != MAP_FAILED){
+				pages = "hugetlb";
+				block = memory;
+				blockLength = length;
+			}
+#endif
+			if(memory == MAP_FAILED){
+				//one huge page more, to align the start
+				memory = mmap(NULL, length + HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if(memory != MAP_FAILED){
+					block = memory;
+					blockLength = length + HUGE_PAGE;
+					memory = (void*)(((size_t)memory + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1));
+#ifdef MADV_HUGEPAGE
+					if(madvise(memory, length, MADV_HUGEPAGE) == 0){
+						pages = "transparent";
+					}
+#endif
+				}
+			}
+			if(memory != MAP_FAILED){
+				mapped = true;
+				data = (T*)memory;
+				return pages;
+			}
+		}
+#else
+		(void)hugePages;
+#endif
+		block = ::operator new(bytes);
+		data = (T*)block;
+		return pages;
+	}
+
+	/**
+	* writes every page of the buffer, before construct
+	*/
+	void prefault(){
+		volatile char *bytes = (volatile char*)data;
+		size_t length = count * sizeof(T);
+		for(size_t i=0; i<length; i+=PAGE){
+			bytes[i] = 0;
+		}
+		bytes[length - 1] = 0;
+	}
+
+	/**
+	* default constructs the elements (leaves them as they are if T has nothing to construct)
+	*/
+	void construct(){
+		if(!std::is_trivially_default_constructible<T>::value){
+			for(size_t i=0; i<count; ++i){
+				new (data + i) T();
+			}
+		}
+		constructed = true;
+	}
+
+	T *get() const { return data; }
+
+private:
+	T *data;
+	size_t count;
+	void *block;
+	size_t blockLength;
+	bool mapped;
+	bool constructed;
+
+	void release(){
+		if(constructed && !std::is_trivially_destructible<T>::value){
+			for(size_t i=0; i<count; ++i){
+				data[i].~T();
+			}
+		}
+		constructed = false;
+#if defined(__linux__)
+		if(mapped){
+			munmap(block, blockLength);
+		}else
+#endif
+		{
+			::operator delete(block);
+		}
+		data = NULL;
+		block = NULL;
+		mapped = false;
+	}
+
+	InputBuffer(const InputBuffer&);
+	InputBuffer &operator=(const InputBuffer&);
+};
+
+/**
+* runs the size x repetition grid of an evaluation on several threads.
+*
+* every (size, repetition) pair is a cell: the generator fills the input buffer of the
+* worker, then the algorithm runs on it and records its counts through the profiler,
+* exactly like the hand written loops do:
+*
+*	SweepRunner<int> runner(p);
+*	runner.run(generate, sort, 100, 10000, 100, 5);
+*	p.divideValues("sort_ops", 5);
+*
+* the cells are dealt to per-worker queues, largest sizes first; a worker that runs out
+* of cells steals the smallest ones left in the other queues. each worker has its own
+* input buffer, and the profiler keeps a shard per thread, so the callbacks only need
+* to be thread safe themselves (no shared globals for the counts).
+* before every cell the engine of the worker (ThreadRandom) is reseeded from the cell's
+* size and repetition, so FillRandomArray gives the same inputs whatever the thread count.
+*
+* runAdaptive times the algorithm instead, repeating every size until its timings are
+* stable (see StoppingRule) rather than a fixed number of times.
+*
+* a sweep that runs for hours can be made resumable: with a log attached to the profiler,
+*
+*	ResultLog log;
+*	log.open("sorts.log");
+*	p.attachLog(log);
+*	runner.checkpoint("bubble");
+*	runner.run(generate, bubble, 100, 10000000, 100, 5);
+*
+* every finished cell is written to the log, and a run started again after a crash
+* skips the cells the log has, with their results loaded from it.
+*
+* runRefined starts from a coarse (geometric) grid and adds sizes where the time per element
+* jumps, e.g. where the input stops fitting in L2 or in the LLC:
+*
+*	runner.runRefined(generate, heapsort, "heapsort", GeometricSizes(1000, 100000000, 4));
+*
+* for timings with less noise, configure the harness (see HarnessOptions):
+*
+*	HarnessOptions options;
+*	options.pinThreads = options.prefault = options.hugePages = true;
+*	options.warmup = 3;
+*	runner.configure(options);
+*
+* the options are written to the environment of the reports, with the pages the buffers got
+*/
+template <typename T>
+class SweepRunner{
+public:
+	typedef std::function<void(T*, int)> Generator;
+	typedef std::function<void(T*, int)> Algorithm;
+
+	/**
+	* threadCount = 0 uses one thread per core
+	*/
+	SweepRunner(Profiler &prof, int threadCount = 0) : profiler(prof), sweep(NULL), cpus(AvailableCpus()){
+		workerCount = threadCount > 0? threadCount: (int)std::thread::hardware_concurrency();
+		if(workerCount < 1){
+			workerCount = 1;
+		}
+	}
+
+	int threads() const { return workerCount; }
+
+	/**
+	* names the cells of the next runs (sweepName has to outlive them), so that they are
+	* written to the log of the profiler when they finish and skipped when the log already
+	* has them; NULL turns it off. every sweep of a program needs its own name
+	*/
+	void checkpoint(const char *sweepName){
+		sweep = sweepName;
+	}
+
+	/**
+	* applies to the next runs. the workers are pinned to the cpus the process may run on,
+	* in order (so pin fewer threads than those, or they share cores)
+	*/
+	void configure(const HarnessOptions &harnessOptions){
+		options = harnessOptions;
+		profiler.setEnvironment("affinity", options.pinThreads? "pinned": "none");
+		profiler.setEnvironment("prefault", options.prefault? "yes": "no");
+		profiler.setEnvironment("warmup", std::to_string(options.warmup).c_str());
+	}
+
+	/**
+	* runs repetitions cells for every size from minSize to maxSize (inclusive), step apart.
+	* returns after all the cells finished and the profiler was flushed; the first exception
+	* thrown by a callback is rethrown here
+	*/
+	void run(Generator generate, Algorithm algorithm, int minSize, int maxSize, int step, int repetitions){
+		run(generate, algorithm, LinearSizes(minSize, maxSize, step), repetitions);
+	}
+
+	/**
+	* the same, for the given sizes (see LinearSizes, GeometricSizes)
+	*/
+	void run(Generator generate, Algorithm algorithm, const std::vector<int> &sizes, int repetitions){
+		std::vector<Cell> cells;
+		for(size_t i=0; i<sizes.size(); ++i){
+			for(int r=0; r<repetitions; ++r){
+				cells.push_back(Cell(sizes[i], r));
+			}
+		}
+		runCells(cells, largest(sizes), [&](T *input, int size){
+			generate(input, size);
+			algorithm(input, size);
+		});
+	}
+
+	/**
+	* times the algorithm on every size from minSize to maxSize, step apart, under series name:
+	* each size is one cell, repeated (with a freshly generated input each time) until rule
+	* is satisfied. the repetitions of every size end up in name_iterations
+	*/
+	void runAdaptive(Generator generate, Algorithm algorithm, const char *name,
+			int minSize, int maxSize, int step, const StoppingRule &rule = StoppingRule()){
+		runAdaptive(generate, algorithm, name, LinearSizes(minSize, maxSize, step), rule);
+	}
+
+	void runAdaptive(Generator generate, Algorithm algorithm, const char *name,
+			const std::vector<int> &sizes, const StoppingRule &rule = StoppingRule()){
+		std::vector<Cell> cells;
+		for(size_t i=0; i<sizes.size(); ++i){
+			cells.push_back(Cell(sizes[i], 0));
+		}
+		runCells(cells, largest(sizes), [&](T *input, int size){
+			profiler.measureTimeAdaptive(name, size,
+				[&]() { generate(input, size); },
+				[&]() { algorithm(input, size); },
+				rule, options.warmup);
+		});
+	}
+
+	/**
+	* times the algorithm (as runAdaptive) on sizes, then keeps adding the geometric mean of two
+	* neighbouring sizes where the median time per element changes sharply between them, see
+	* RefineRule. every round of new sizes runs in parallel; for cache effects use one thread,
+	* as the workers share the caches. returns the sizes measured, in ascending order
+	*/
+	std::vector<int> runRefined(Generator generate, Algorithm algorithm, const char *name, const std::vector<int> &sizes,
+			const RefineRule &refine = RefineRule(), const StoppingRule &rule = StoppingRule()){
+		std::vector<int> measured = sizes;
+		std::sort(measured.begin(), measured.end());
+		measured.erase(std::unique(measured.begin(), measured.end()), measured.end());
+		runAdaptive(generate, algorithm, name, measured, rule);
+		int added = 0;
+		while(added < refine.maxSizes){
+			std::vector<std::pair<double, int> > candidates;
+			for(size_t i=0; i+1<measured.size(); ++i){
+				int a = measured[i], b = measured[i + 1];
+				int middle = (int)(sqrt((double)a * b) + 0.5);
+				if(a <= 0 || (double)b / a < refine.minRatio || middle <= a || middle >= b){
+					continue;
+				}
+				double costA = profiler.summary(name, a).median / a, costB = profiler.summary(name, b).median / b;
+				if(costA <= 0.0 || costB <= 0.0){
+					continue;
+				}
+				double jump = fabs(log(costB / costA));
+				if(jump > log(1.0 + refine.threshold)){
+					candidates.push_back(std::make_pair(jump, middle));
+				}
+			}
+			if(candidates.empty()){
+				break;
+			}
+			//the sharpest changes first, if the budget does not cover them all
+			std::sort(candidates.rbegin(), candidates.rend());
+			std::vector<int> next;
+			for(size_t i=0; i<candidates.size() && added < refine.maxSizes; ++i, ++added){
+				next.push_back(candidates[i].second);
+			}
+			runAdaptive(generate, algorithm, name, next, rule);
+			measured.insert(measured.end(), next.begin(), next.end());
+			std::sort(measured.begin(), measured.end());
+		}
+		return measured;
+	}
+
+private:
+	typedef std::function<void(T*, int)> CellAction;
+
+	struct Cell{
+		int size;
+		int repetition;
+
+		Cell(int s, int r) : size(s), repetition(r) {}
+
+		/**
+		* the random stream of the cell, apart from the ones of the threads
+		*/
+		unsigned long long stream() const{
+			return (1ULL << 63) | ((unsigned long long)(unsigned int)size << 31) | (unsigned int)repetition;
+		}
+
+		static bool largerFirst(const Cell &a, const Cell &b){
+			return a.size > b.size;
+		}
+	};
+
+	struct WorkQueue{
+		std::deque<Cell> cells;
+		std::mutex lock;
+	};
+
+	Profiler &profiler;
+	int workerCount;
+	const char *sweep;
+	HarnessOptions options;
+	std::vector<int> cpus;
+	std::deque<InputBuffer<T> > buffers;
+	std::deque<WorkQueue> queues;
+	std::mutex failureLock;
+	std::exception_ptr failure;
+
+	static int largest(const std::vector<int> &sizes){
+		return sizes.empty()? 0: *std::max_element(sizes.begin(), sizes.end());
+	}
+
+	void runCells(std::vector<Cell> &cells, int maxSize, CellAction action){
+		if(sweep != NULL){
+			std::vector<Cell> left;
+			for(size_t i=0; i<cells.size(); ++i){
+				if(!profiler.finished(sweep, cells[i].size, cells[i].repetition)){
+					left.push_back(cells[i]);
+				}
+			}
+			cells.swap(left);
+		}
+		std::stable_sort(cells.begin(), cells.end(), Cell::largerFirst);
+
+		queues.clear();
+		queues.resize(workerCount);
+		for(size_t i=0; i<cells.size(); ++i){
+			queues[i % workerCount].cells.push_back(cells[i]);
+		}
+		failure = std::exception_ptr();
+
+		//reserved here, touched by their workers
+		buffers.clear();
+		buffers.resize(workerCount);
+		const char *pages = "normal";
+		for(int w=0; w<workerCount; ++w){
+			pages = buffers[w].allocate(maxSize, options.hugePages);
+		}
+		profiler.setEnvironment("input_pages", pages);
+
+		std::vector<std::thread> workers;
+		for(int w=1; w<workerCount; ++w){
+			workers.push_back(std::thread(&SweepRunner::work, this, w, action));
+		}
+		work(0, action);
+		for(size_t i=0; i<workers.size(); ++i){
+			workers[i].join();
+		}
+
+		buffers.clear();
+		profiler.flush();
+		if(failure){
+			std::rethrow_exception(failure);
+		}
+	}
+
+	/**
+	* takes the largest cell left in the queue of the worker,
+	* or steals the smallest cell of another worker
+	*/
+	bool next(int worker, Cell &cell){
+		for(int i=0; i<workerCount; ++i){
+			WorkQueue &queue = queues[(worker + i) % workerCount];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if(queue.cells.empty()){
+				continue;
+			}
+			if(i == 0){
+				cell = queue.cells.front();
+				queue.cells.pop_front();
+			}else{
+				cell = queue.cells.back();
+				queue.cells.pop_back();
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void work(int worker, CellAction action){
+		ThreadPin pin(options.pinThreads? cpus[worker % cpus.size()]: -1);
+		InputBuffer<T> &input = buffers[worker];
+		if(options.prefault){
+			input.prefault();
+		}
+		input.construct();
+		Cell cell(0, 0);
+		while(next(worker, cell)){
+			try{
+				ThreadRandom().seed(RandomSeed(), cell.stream());
+				action(input.get(), cell.size);
+				if(sweep != NULL){
+					profiler.checkpoint(sweep, cell.size, cell.repetition);
+				}
+			}catch(...){
+				std::lock_guard<std::mutex> guard(failureLock);
+				if(!failure){
+					failure = std::current_exception();
+				}
+			}
+		}
+		//the other workers end here, worker 0 is the thread that called run
+		if(worker != 0){
+			profiler.retireThread();
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,244 @@
+/**
+* runs any algorithm of the labs on any input, without editing main:
+*
+*	benchmark [options] [algorithm patterns]
+*
+*	-l              list the algorithms (with their default sizes) and the inputs
+*	-a patterns     algorithms to run, comma separated globs ("quick/sort_*,heap/?ort"), all by default
+*	-i patterns     inputs to run them on, random by default
+*	-s min:max:step sizes, linear; min:max:xfactor for geometric ones (default: the range of the algorithm)
+*	-r count        repetitions of every size (5); with -m time, the least number of them
+*	-j count        threads (one per core)
+*	-m ops|time|counters
+*	                count the operations (OpCounter), time the uninstrumented algorithm, or read the
+*	                hardware counters (cycles, instructions, misses; Linux, see Profiler::startCounters)
+*	                around it
+*	-R threshold    with -m time, add sizes where the time per element changes by more than
+*	                threshold (0.1 = 10%) between two neighbouring sizes, up to -N more sizes (32)
+*	-f format       html (a report-*.html file), json, csv or binary
+*	-o file         where json, csv and binary go (stdout)
+*	-c file         result log: finished sizes are kept there and skipped when run again
+*	-t title        title of the report
+*	-x seed         seed of the inputs
+*	-P              pin every thread to its own core
+*	-F              write every page of the input buffers before the first size
+*	-H              put the input buffers on huge pages, when the system has them
+*	-w count        untimed runs of every size before timing it (1), with -m time
+*
+* the report records the machine, the compiler, the git revision and these options
+*
+* the series are named <algorithm>_<input> (with '_' for '/'): _assign, _comp and _ops
+* for operations, the times under the name itself, and _cycles, _instructions, _IPC and the
+* misses for counters; the series of every input are grouped
+*/
+#include "Labs.h"
+
+#include <deque>
+
+static int usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [-l] [-a patterns] [-i patterns] [-s min:max:step|min:max:xfactor] [-r count]\n"
+                    "       [-j threads] [-m ops|time|counters] [-R threshold] [-N sizes] [-f html|json|csv|binary] [-o file]\n"
+                    "       [-c log] [-t title] [-x seed] [-P] [-F] [-H] [-w count] [algorithm patterns]\n", program);
+    return 2;
+}
+
+static std::string seriesName(const std::string &algorithm, const std::string &input)
+{
+    std::string name = algorithm + "_" + input;
+    for(size_t i = 0; i < name.size(); i++)
+    {
+        if(!isalnum((unsigned char)name[i]) && name[i] != '_') name[i] = '_';
+    }
+    return name;
+}
+
+static void list(const Registry &registry)
+{
+    const std::vector<AlgorithmEntry> &algorithms = registry.algorithms();
+    printf("algorithms:\n");
+    for(size_t i = 0; i < algorithms.size(); i++)
+    {
+        const SizeRange &sizes = algorithms[i].sizes;
+        if(sizes.factor > 1.0) printf("  %-28s %d:%d:x%g\n", algorithms[i].name.c_str(), sizes.minSize, sizes.maxSize, sizes.factor);
+        else printf("  %-28s %d:%d:%d\n", algorithms[i].name.c_str(), sizes.minSize, sizes.maxSize, sizes.step);
+    }
+    printf("inputs:\n");
+    for(size_t i = 0; i < registry.inputs().size(); i++)
+    {
+        printf("  %s\n", registry.inputs()[i].name.c_str());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Registry &registry = Registry::instance();
+    RegisterSorting(registry);
+    RegisterHeapsort(registry);
+    RegisterQuicksort(registry);
+    RegisterInputs(registry);
+
+    std::string algorithmPatterns, inputPatterns = "random", measure = "ops", format = "html";
+    const char *output = NULL, *logName = NULL, *title = "benchmark";
+    SizeRange sizes;
+    bool sizesGiven = false;
+    RefineRule refine;
+    bool refining = false;
+    int repetitions = 5, threads = 0;
+    HarnessOptions harness;
+    for(int i = 1; i < argc; i++)
+    {
+        const char *option = argv[i];
+        if(strcmp(option, "-l") == 0)
+        {
+            list(registry);
+            return 0;
+        }
+        if(option[0] != '-')
+        {
+            algorithmPatterns += (algorithmPatterns.empty()? "": ",") + std::string(option);
+            continue;
+        }
+        if(strcmp(option, "-P") == 0 || strcmp(option, "-F") == 0 || strcmp(option, "-H") == 0)
+        {
+            if(option[1] == 'P') harness.pinThreads = true;
+            else if(option[1] == 'F') harness.prefault = true;
+            else harness.hugePages = true;
+            continue;
+        }
+        if(option[1] == '\0' || option[2] != '\0' || i + 1 >= argc) return usage(argv[0]);
+        const char *value = argv[++i];
+        switch(option[1])
+        {
+            case 'a': algorithmPatterns += (algorithmPatterns.empty()? "": ",") + std::string(value); break;
+            case 'i': inputPatterns = value; break;
+            case 's':
+                if(!sizes.parse(value)) return usage(argv[0]);
+                sizesGiven = true;
+                break;
+            case 'r': repetitions = atoi(value); break;
+            case 'j': threads = atoi(value); break;
+            case 'm': measure = value; break;
+            case 'R':
+                refine.threshold = atof(value);
+                refining = true;
+                break;
+            case 'N': refine.maxSizes = atoi(value); break;
+            case 'f': format = value; break;
+            case 'o': output = value; break;
+            case 'c': logName = value; break;
+            case 't': title = value; break;
+            case 'x': SeedRandom(strtoull(value, NULL, 0)); break;
+            case 'w': harness.warmup = atoi(value); break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(algorithmPatterns.empty()) algorithmPatterns = "*";
+    if(repetitions < 1 || harness.warmup < 0 || (measure != "ops" && measure != "time" && measure != "counters") || (refining && measure != "time") ||
+       (format != "html" && format != "json" && format != "csv" && format != "binary"))
+    {
+        return usage(argv[0]);
+    }
+
+    std::vector<const AlgorithmEntry*> algorithms = registry.algorithms(algorithmPatterns);
+    std::vector<const InputEntry*> inputs = registry.inputs(inputPatterns);
+    if(algorithms.empty() || inputs.empty())
+    {
+        fprintf(stderr, "%s: no %s matches, see -l\n", argv[0], algorithms.empty()? "algorithm": "input");
+        return 2;
+    }
+
+    Profiler p(title);
+    ResultLog log;
+    if(logName)
+    {
+        if(!log.open(logName))
+        {
+            fprintf(stderr, "%s: can not open the result log %s\n", argv[0], logName);
+            return 2;
+        }
+        p.attachLog(log);
+    }
+    SweepRunner<int> runner(p, threads);
+    runner.configure(harness);
+    //the checkpoint names have to outlive the runs
+    std::deque<std::string> names;
+    std::map<std::string, std::vector<std::string> > groups;
+
+    for(size_t a = 0; a < algorithms.size(); a++)
+    {
+        const AlgorithmEntry &algorithm = *algorithms[a];
+        std::vector<int> grid = (sizesGiven? sizes: algorithm.sizes).sizes();
+        for(size_t k = 0; k < inputs.size(); k++)
+        {
+            const InputEntry &input = *inputs[k];
+            names.push_back(seriesName(algorithm.name, input.name));
+            const std::string &name = names.back();
+            runner.checkpoint(logName? name.c_str(): NULL);
+            fprintf(stderr, "%s on %s: %d sizes\n", algorithm.name.c_str(), input.name.c_str(), (int)grid.size());
+
+            if(measure == "time")
+            {
+                StoppingRule rule;
+                rule.minRepetitions = repetitions;
+                if(refining)
+                {
+                    grid = runner.runRefined(input.generate, algorithm.plain, name.c_str(), grid, refine, rule);
+                    fprintf(stderr, "    refined to %d sizes\n", (int)grid.size());
+                }
+                else runner.runAdaptive(input.generate, algorithm.plain, name.c_str(), grid, rule);
+                groups[input.name].push_back(name);
+                continue;
+            }
+
+            if(measure == "counters")
+            {
+                runner.run(input.generate, [&](int *a, int n)
+                {
+                    p.startCounters(name.c_str(), n);
+                    algorithm.plain(a, n);
+                    p.stopCounters(name.c_str(), n);
+                }, grid, repetitions);
+                p.divideCounters(name.c_str(), repetitions);
+                groups[input.name + "_IPC"].push_back(name + "_IPC");
+                continue;
+            }
+
+            std::string assign = name + "_assign", comp = name + "_comp", ops = name + "_ops";
+            Profiler::SeriesId assignId = p.seriesId(assign.c_str()), compId = p.seriesId(comp.c_str());
+            runner.run(input.generate, [&](int *a, int n)
+            {
+                OpCounter c;
+                algorithm.counted(a, n, c);
+                p.countOperation(assignId, n, c.assignments);
+                p.countOperation(compId, n, c.comparisons);
+            }, grid, repetitions);
+            p.divideValues(assign.c_str(), repetitions);
+            p.divideValues(comp.c_str(), repetitions);
+            p.addSeries(ops.c_str(), assign.c_str(), comp.c_str());
+            groups[input.name].push_back(ops);
+        }
+    }
+    for(std::map<std::string, std::vector<std::string> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
+    {
+        p.createGroup(it->first.c_str(), it->second);
+    }
+
+    if(format == "html") return p.showReport() == 0? 0: 1;
+    Profiler::ExportFormat exportFormat = format == "json"? Profiler::EXPORT_JSON:
+                                          (format == "csv"? Profiler::EXPORT_CSV: Profiler::EXPORT_BINARY);
+    int result;
+    if(output)
+    {
+        FILE *fout = fopen(output, "wb");
+        if(fout == NULL)
+        {
+            fprintf(stderr, "%s: can not write %s\n", argv[0], output);
+            return 1;
+        }
+        result = p.exportResults(fout, exportFormat);
+        fclose(fout);
+    }
+    else result = p.exportResults(1, exportFormat);
+    return result == 0? 0: 1;
+}
@@ -19,8 +19,8 @@ void createGroup(int step, int max_size)
 {
     for(int n = 1; n < max_size; n += step)
     {
-        prof.countOperation("100_log_n", n, 100 * log(n));
-        prof.countOperation("2_n", n, pow(2, n));
+        prof.addValue("100_log_n", n, 100 * log(n));
+        prof.addValue("2_n", n, pow(2, n));
         prof.countOperation("2_n_fact", n, 2 * fact(n));
     }
 
@@ -28,7 +28,7 @@ void createGroup(int step, int max_size)
     {
         prof.countOperation("n", n, n);
         prof.countOperation("10_n", n, 10 * n);
-        prof.countOperation("0.5_n_2", n, 0.5 * n * n);
+        prof.addValue("0.5_n_2", n, 0.5 * n * n);
     }
 
     prof.createGroup("Functions_1", "n",  "10_n", "0.5_n_2");
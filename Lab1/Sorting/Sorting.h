@@ -0,0 +1,200 @@
+#ifndef SORTING_H_INCLUDED
+#define SORTING_H_INCLUDED
+
+/** The direct sorts of the lab, for any counting policy of Profiler.h (OpCounter, NullCounter, TraceCounter)
+    The benchmark registers these same functions
+*/
+
+/** Selection sort
+
+    It is the sorting algorithm, which goes through the array, at each step selecting the minimum of the remaining items,
+    and swapping them with the current one
+
+    Behavior:
+                Assignments     Comparisons
+    Best case:      3               n-i+1 -> O(n^2)
+    Worst case:     3               n-i+1
+
+    Stability: This algorithm is unstable, because if there is at least one value identical with the value at the current
+    iteration and the minimum comes after it, the minimum will get swapped with the first item, and the order of the
+    identical values is broken.
+ */
+template <typename Counter>
+void selectSort(int a[], int n, Counter &c)
+{
+    for(int i = 0; i < n - 1; i++) //main loop
+    {
+        //count assignments, operations
+
+        //at each step select the index of minimum from the remaining items
+        int min = i;
+        c.assign();
+
+        c.trace(a, n);
+
+        for(int j = i; j < n; j++)
+        {
+            //search min
+            c.compare();
+
+            if(a[j] < a[min])
+            {
+                min = j;
+            }
+        }
+
+        c.assign(3);
+        //swap next element with the minimum
+        int temp = a[i];
+        a[i] = a[min];
+        a[min] = temp;
+    }
+}
+
+/** Insertion sort
+
+    It is the sorting algorithm, which goes through the array, inserts the item at the current iteration into its correct place
+    building the sorted array one item at a time
+
+    Behavior:
+                Assignments     Comparisons
+    Best case:      2               1
+    Worst case:     i+2             i+1 -> O(n^2)
+
+    Stability: This algorithm is stable, because of the strict "<" relation between the rest of the array and the buffer.
+    The current item will not go backwards if it reaches a value equal with it.
+ */
+template <typename Counter>
+void insertionSort(int a[], int n, Counter &c)
+{
+    for(int i = 1; i < n; i++)
+    {
+        int buf = a[i];
+        int j = i - 1;
+
+        c.assign();
+
+        c.trace(a, n);
+
+        for(; j >= 0 && a[j] > buf; j--) //shift the whole array until the correct position of the buffer is reached (j first, so that a[-1] is never read)
+        {
+            c.compare();
+
+            a[j + 1] = a[j];
+
+            c.assign();
+        }
+
+        c.compare();
+
+        a[j + 1] = buf;
+
+        c.assign();
+    }
+}
+
+/** Bubble sort
+
+    It is the sorting algorithm, which goes through the array, and swaps two adjacent items, is their order is not correct.
+    The maximum value is guaranteed to "bubble up" to the end, when an iteration is finished. It does this n-1 times, so that
+    each value has a chance to reach its correct position when the algorithm finishes -> O(n^2)
+
+    Behavior:
+                Assignments     Comparisons
+    Best case:      0               i
+    Worst case:     3i              i
+
+    Stability: This algorithm is stable by nature (swap doesn't occur for equal items)
+ */
+template <typename Counter>
+void bubbleSort(int a[], int n, Counter &c)
+{
+    //compare two consecutive elements, if an element is not on the correct position swap them
+    for(int i = 0; i < n - 1; i++)
+    {
+        c.trace(a, n);
+
+        for(int j = 0; j < n - 1; j++)
+        {
+            c.compare();
+
+            if(a[j] > a[j + 1])
+            {
+                c.assign(3);
+
+                int temp = a[j];
+                a[j] = a[j + 1];
+                a[j + 1] = temp;
+            }
+        }
+    }
+}
+
+/** Algorithm for the binary search, modified so it finds where the selected value would belong
+
+*/
+template <typename Counter>
+int binSearch(int a[], int x, int l, int r, Counter &c)
+{
+    c.compare();
+    if(l >= r) //value is not found, check if it belongs to left or right of the selected item
+    {
+        c.compare();
+        if (x > a[l]) return l + 1;
+        else return l;
+    }
+
+    int m = (l + r) / 2; //find middle index
+
+    if(a[m] == x) return m + 1;  //in case of identical items, return middle + 1 to ensure stability
+
+    else //search in left or right subarray
+    {
+        c.compare();
+        if(x > a[m]) return binSearch(a, x, m + 1, r, c);
+        else return binSearch(a, x, l, m, c);
+    }
+}
+
+/** Binary insertion sort
+    Same as linear insertion sort, but uses binary search to find where the item at the current iteration belongs
+
+    Behavior:
+                Assignments     Comparisons
+    Best case:      2               log2(i)
+    Worst case:     i+2             log2(3i) -> still O(n^2) efficiency
+
+    Stability: This algorithm is still stable, because in the binary search if the value is found, the selected position will be found + 1.
+*/
+template <typename Counter>
+void BinsertionSort(int a[], int n, Counter &c)
+{
+    for(int i = 1; i < n; i++)
+    {
+        int buf = a[i];
+        int j = i - 1;
+
+        c.assign();
+
+        c.trace(a, n);
+
+        //search the correct place for the buffer
+
+        int k = binSearch(a, buf, 0, j, c); //search in the already sorted part
+
+        for(; j >= k; j--) //shift the whole array until j < k
+        {
+            a[j + 1] = a[j];
+
+            c.assign();
+        }
+
+        c.compare();
+
+        a[j + 1] = buf;
+
+        c.assign();
+    }
+}
+
+#endif // SORTING_H_INCLUDED
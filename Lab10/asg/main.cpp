@@ -62,7 +62,7 @@ int edgecount = 0;
 
 int random(int x, int y)
 {
-    return (rand() % (y - x)) + x;
+    return (int)ThreadRandom().uniform(x, y - 1);
 }
 
 void initEdges()
@@ -567,7 +567,6 @@ void eval_DFS2()
 
 int main()
 {
-    srand(time(0));
     demo();
     topological_sort();
     eval_DFS1();
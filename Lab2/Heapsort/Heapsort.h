@@ -0,0 +1,119 @@
+#ifndef HEAPSORT_H_INCLUDED
+#define HEAPSORT_H_INCLUDED
+
+#include <algorithm>
+
+/** The max - heap of the lab, for any counting policy of Profiler.h (OpCounter, NullCounter, TraceCounter)
+    The size of the heap is passed along instead of kept in a global, so that the benchmark can run it on several threads
+    Lab3 (heap sort against quick sort) and the benchmark use these same functions. levelCompares is what a level of
+    heapify down costs: Lab2 counts the 2 value comparisons, Lab3 counts the 2 bound checks as well (4)
+*/
+
+inline int parent(int i)
+{
+    return (i - 1) / 2;
+}
+
+inline int left(int i)
+{
+    return 2 * i + 1;
+}
+
+inline int right(int i)
+{
+    return 2 * i + 2;
+}
+
+template <typename Counter>
+void heapify_down(int h[], int heapsize, int i, Counter &c, int levelCompares = 2) //sink the root into the heaviest branch
+{
+    int largest_ind;
+    //swap largest child with node
+    if(left(i) < heapsize && h[left(i)] > h[i])
+    {
+        largest_ind = left(i);
+    }
+
+    else largest_ind = i;
+
+    if (right(i) < heapsize && h[right(i)] > h[largest_ind]) largest_ind = right(i);
+
+    c.compare(levelCompares);
+    if(largest_ind != i)
+    {
+        std::swap(h[i], h[largest_ind]);
+        c.assign(3);
+
+        heapify_down(h, heapsize, largest_ind, c, levelCompares);
+    }
+}
+
+template <typename Counter>
+void heapify_up(int h[], int i, Counter &c) //bubble up the index
+{
+    //if parent exists, and is bigger then index, swap!
+    c.compare(2);
+    if(parent(i) >= 0 && h[parent(i)] < h[i])
+    {
+        std::swap(h[i], h[parent(i)]);
+        c.assign(3);
+
+        //walk upwards
+        heapify_up(h, parent(i), c);
+    }
+}
+
+template <typename Counter>
+void push_heap(int h[], int &heapsize, int x, Counter &c)
+{
+    //add element to the last spot
+    h[heapsize] = x;
+    c.assign();
+
+    //increase heap size
+    heapsize++;
+
+    //heapify
+    heapify_up(h, heapsize - 1, c);
+}
+
+template <typename Counter>
+void build_max_heap_bottom_up(int h[], int n, Counter &c, int levelCompares = 2)
+{
+    for(int i = (n/2); i >= 0; i--)
+    {
+        c.trace(h, n);
+
+        heapify_down(h, n, i, c, levelCompares);
+    }
+}
+
+template <typename Counter>
+void build_max_heap_top_down(int h[], int n, Counter &c)
+{
+    int heapsize = 1;
+
+    for(int i = 1; i < n; i++)
+    {
+        c.trace(h, n);
+
+        push_heap(h, heapsize, h[i], c);
+    }
+}
+
+template <typename Counter>
+void heapsort(int h[], int n, Counter &c, int levelCompares = 2)
+{
+    build_max_heap_bottom_up(h, n, c, levelCompares);
+
+    for(int i = n - 1; i >= 1; i--)
+    {
+        c.trace(h, n);
+
+        std::swap(h[0], h[i]);
+
+        heapify_down(h, i, 0, c, levelCompares);
+    }
+}
+
+#endif // HEAPSORT_H_INCLUDED
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include "Profiler.h"
+#include "Heapsort.h"
 
 #define MAX_SIZE 100000
 /**
@@ -37,16 +38,9 @@
 */
 
 Profiler p("Heap sort");
-int tdo, buo;
 
 int heap[MAX_SIZE] = {0};
 
-int heapsize = 0;
-
-int parent(int i);
-int left(int i);
-int right(int i);
-
 void print_A(int a[], int n)
 {
     for(int i = 0; i < n; i++)
@@ -56,141 +50,28 @@ void print_A(int a[], int n)
     printf("\n");
 }
 
-void heapify_up(int h[], int i);
-void heapify_down(int h[], int i);
-
-void build_max_heap_bottom_up(int h[], int i, bool print);
-void build_max_heap_top_down(int h[], int i, bool print);
-
-void heapsort(int h[], int n);
-
-void push_heap(int h[], int x);
-
-int parent(int i)
-{
-    return (i - 1) /2;
-}
-
-int left(int i)
-{
-    return 2 * i + 1;
-}
-
-int right(int i)
-{
-    return 2 * i + 2;
-}
-
-void heapify_down(int h[], int i) //sink the root into the heaviest branch
-{
-    int largest_ind;
-    //swap largest child with node
-    if(left(i) < heapsize && h[left(i)] > h[i])
-    {
-        largest_ind = left(i);
-    }
-
-    else largest_ind = i;
-
-    if (right(i) < heapsize && h[right(i)] > h[largest_ind]) largest_ind = right(i);
-
-    buo += 2;
-    if(largest_ind != i)
-    {
-        std::swap(h[i], h[largest_ind]);
-        buo += 3;
-
-        heapify_down(h, largest_ind);
-    }
-}
-
-void heapify_up(int h[], int i) //bubble up the index
-{
-    //if parent exists, and is bigger then index, swap!
-    tdo += 2;
-    if(parent(i) >= 0 && h[parent(i)] < h[i])
-    {
-        std::swap(h[i], h[parent(i)]);
-        tdo += 3;
-
-        //walk upwards
-        heapify_up(h, parent(i));
-    }
-}
-
-void build_max_heap_bottom_up(int h[], int n, bool print)
-{
-    heapsize = n;
-
-    for(int i = (n/2); i >= 0; i--)
-    {
-        if(print) print_A(h, n);
-
-        heapify_down(h, i);
-    }
-}
-
-void build_max_heap_top_down(int h[], int n, bool print = false)
-{
-    heapsize = 1;
-
-    for(int i = 1; i < n; i++)
-    {
-        if(print) print_A(h, n);
-
-        push_heap(h, h[i]);
-    }
-}
-
-void heapsort(int h[], int n)
-{
-    build_max_heap_bottom_up(h, n, false);
-
-    for(int i = n - 1; i >= 1; i--)
-    {
-        print_A(h, n);
-
-        std::swap(h[0], h[i]);
-
-        heapsize--;
-
-        heapify_down(h, 0);
-    }
-}
-
-void push_heap(int h[], int x)
-{
-    //add element to the last spot
-    h[heapsize] = x;
-    tdo++;
-
-    //increase heap size
-    heapsize++;
-
-    //heapify
-    heapify_up(h, heapsize - 1);
-}
-
 /** TEST FUNCTIONS GO HERE*/
 void test()
 {
     printf("BOTTOM UP BUILD TEST:\n");
     //test BU heap build
+    TraceCounter tracer;
+
     FillRandomArray(heap, 10, 0, 9, true, UNSORTED);
-    build_max_heap_bottom_up(heap, 10, true);
+    build_max_heap_bottom_up(heap, 10, tracer);
     print_A(heap, 10);
 
     printf("TOP DOWN BUILD TEST:\n");
     //test TD heap build
     FillRandomArray(heap, 10, 0, 9, true, ASCENDING);
-    build_max_heap_top_down(heap, 10, true);
+    build_max_heap_top_down(heap, 10, tracer);
     print_A(heap, 10);
 
     printf("HEAPSORT TEST:\n");
     //test heap sort
     FillRandomArray(heap, 20, 0, 99, false, UNSORTED);
     print_A(heap, 20);
-    heapsort(heap, 20);
+    heapsort(heap, 20, tracer);
     print_A(heap, 20);
 }
 
@@ -212,16 +93,15 @@ void eval(SortMethod method, char TD_name[50], char BU_name[50], char chart_name
 
                 CopyArray(heap_beta, heap, n);
 
-                buo = 0;
-                tdo = 0;
+                OpCounter buo, tdo;
 
-                build_max_heap_bottom_up(heap, n, false);
+                build_max_heap_bottom_up(heap, n, buo);
                 //count operations
-                p.countOperation(BU_name, n, buo);
+                p.countOperation(BU_name, n, buo.total());
 
-                build_max_heap_top_down(heap_beta, n, false);
+                build_max_heap_top_down(heap_beta, n, tdo);
 
-                p.countOperation(TD_name, n, tdo);
+                p.countOperation(TD_name, n, tdo.total());
             }
         }
 
@@ -232,16 +112,15 @@ void eval(SortMethod method, char TD_name[50], char BU_name[50], char chart_name
 
                 CopyArray(heap_beta, heap, n);
 
-                buo = 0;
-                tdo = 0;
+                OpCounter buo, tdo;
 
-                build_max_heap_bottom_up(heap, n, false);
+                build_max_heap_bottom_up(heap, n, buo);
                 //count operations
-                p.countOperation(BU_name, n, buo);
+                p.countOperation(BU_name, n, buo.total());
 
-                build_max_heap_top_down(heap_beta, n, false);
+                build_max_heap_top_down(heap_beta, n, tdo);
 
-                p.countOperation(TD_name, n, tdo);
+                p.countOperation(TD_name, n, tdo.total());
         }
     }
 
@@ -0,0 +1,125 @@
+#ifndef QUICKSORT_H_INCLUDED
+#define QUICKSORT_H_INCLUDED
+
+#include "Profiler.h"
+
+/** Quick sort and quick select of the lab, for any counting policy of Profiler.h and any element type with "<"
+    (the adversary of FillQuicksortKiller sorts AdversaryItems with them)
+    The pivot is the last element (part), the middle one (part_m) or a random one (part_rand)
+    The benchmark registers these same functions
+*/
+
+template <typename T, typename Counter>
+int part_rand(T a[], int l, int r, Counter &c)
+{
+    int pivot = (int)ThreadRandom().uniform(l, r - 1);
+
+    std::swap(a[pivot], a[r]); //swap pivot with last element, now a[r] is the pivot
+
+    c.assign(3);
+
+    int i = l - 1;
+
+    for(int j = l; j < r; j++)
+    {
+        c.compare();
+        if(a[j] < a[r]) //then swap
+        {
+            c.assign(3);
+            i++;
+            std::swap(a[i], a[j]);
+        }
+    }
+
+    c.assign(3);
+    std::swap(a[i + 1], a[r]);
+
+    return i + 1;
+}
+
+template <typename T, typename Counter>
+int part(T a[], int l, int r, Counter &c)
+{
+    T pivot = a[r];
+    c.assign();
+
+    int i = l - 1;
+
+    for(int j = l; j < r; j++)
+    {
+        c.compare();
+        if(a[j] < pivot) //then swap
+        {
+            c.assign(3);
+            i++;
+            std::swap(a[i], a[j]);
+        }
+    }
+
+    c.assign(3);
+    std::swap(a[i + 1], a[r]);
+
+    return i + 1;
+}
+
+template <typename T, typename Counter>
+int part_m(T a[], int l, int r, Counter &c)
+{
+    int pivot = (l + r) / 2;
+
+    std::swap(a[pivot], a[r]); //swap pivot with last element, now a[r] is the pivot
+
+    c.assign(3);
+
+    int i = l - 1;
+
+    for(int j = l; j < r; j++)
+    {
+        c.compare();
+        if(a[j] < a[r]) //then swap
+        {
+            c.assign(3);
+            i++;
+            std::swap(a[i], a[j]);
+        }
+    }
+
+    c.assign(3);
+    std::swap(a[i + 1], a[r]);
+
+    return i + 1;
+}
+
+template <typename T, typename Counter>
+void quicksort(T a[], int (*part_func)(T*, int, int, Counter&), int l, int r, Counter &c)
+{
+    if(l < r)
+    {
+        CounterSpan<Counter> span(c, "quicksort");
+        c.trace(a, r + 1);
+
+        int pivotIndex = part_func(a, l, r, c);
+
+        quicksort(a, part_func, l, pivotIndex - 1, c);
+        quicksort(a, part_func, pivotIndex + 1, r, c);
+    }
+}
+
+template <typename Counter>
+int quickselect(int a[], int l, int r, int i, Counter &c)
+{
+    if(l == r) return a[l];
+
+    CounterSpan<Counter> span(c, "quickselect");
+    int q = part_rand(a, l, r, c);
+    int k = q - l + 1;
+
+    c.trace(a, r + 1);
+
+    if(i == k) return a[q];
+
+    else if(i < k) return quickselect(a, l, q - 1, i, c);
+    return quickselect(a, q + 1, r, i - k, c);
+}
+
+#endif // QUICKSORT_H_INCLUDED
@@ -1,4 +1,6 @@
 #include "Profiler.h"
+#include "Quicksort.h"
+#include "../../Lab2/Heapsort/Heapsort.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -45,9 +47,6 @@ but not all of it, like heap sort. The worst case of quick sort can be easily el
 Profiler p("QuickSort - HeapSort");
 
 int arr[MAX_SIZE];
-int ops;
-
-int heapsize = 0;
 
 void print_A(int a[], int n)
 {
@@ -58,192 +57,12 @@ void print_A(int a[], int n)
     printf("\n");
 }
 
-int part_rand(int a[], int l, int r);
-int part(int a[], int l, int r);
-void quicksort(int a[], int (*part_func)(int*, int, int), int l, int r, bool flag);
-int quickselect(int a[], int l, int r, int i, bool flag);
-
-int part_rand(int a[], int l, int r)
-{
-    srand(time(0));
-
-    int pivot = rand() % (r - l) + l;
-
-    //printf("Pivot index: %d, pivot: %d\n\n", pivot, arr[pivot]);
-
-    std::swap(a[pivot], a[r]); //swap pivot with last element, now a[r] is the pivot
-
-    ops += 3;
-
-    int i = l - 1;
-
-    for(int j = l; j < r; j++)
-    {
-        ops++;
-        if(a[j] < a[r]) //then swap
-        {
-            ops += 3;
-            i++;
-            std::swap(a[i], a[j]);
-        }
-    }
-
-    ops += 3;
-    std::swap(a[i + 1], a[r]);
-
-    return i + 1;
-}
-
-int part(int a[], int l, int r)
-{
-    int pivot = a[r];
-    ops += 1;
-
-    int i = l - 1;
-
-    for(int j = l; j < r; j++)
-    {
-        ops++;
-        if(a[j] < pivot) //then swap
-        {
-            ops += 3;
-            i++;
-            std::swap(a[i], a[j]);
-        }
-    }
-
-    ops += 3;
-    std::swap(a[i + 1], a[r]);
-
-    return i + 1;
-}
-
-int part_m(int a[], int l, int r)
-{
-    int pivot = (l + r) / 2;
-
-    std::swap(a[pivot], a[r]); //swap pivot with last element, now a[r] is the pivot
-
-    ops += 3;
-
-    int i = l - 1;
-
-    for(int j = l; j < r; j++)
-    {
-        ops++;
-        if(a[j] < a[r]) //then swap
-        {
-            ops += 3;
-            i++;
-            std::swap(a[i], a[j]);
-        }
-    }
-
-    ops += 3;
-    std::swap(a[i + 1], a[r]);
-
-    return i + 1;
-}
-
-void quicksort(int a[], int (*part_func)(int*, int, int),int l, int r, bool flag)
-{
-    if(l < r)
-    {
-        if(flag) print_A(a, 10);
-
-        int pivotIndex = part_func(a, l, r);
-
-        quicksort(a, part_func, l, pivotIndex - 1, flag);
-        quicksort(a, part_func, pivotIndex + 1, r, flag);
-    }
-}
-
-int quickselect(int a[], int l, int r, int i, bool flag)
-{
-    if(l == r) return a[l];
-
-    int q = part_rand(a, l, r);
-    int k = q - l + 1;
-
-    if(flag)
-    {
-        print_A(a, 10);
-        printf("pivot: %d\n", a[q]);
-    }
-
-    if(i == k) return a[q];
-
-    else if(i < k) return quickselect(a, l, q - 1, i, flag);
-    return quickselect(a, q + 1, r, i - k, flag);
-}
-
-int parent(int i)
-{
-    return (i - 1) /2;
-}
-
-int left(int i)
-{
-    return 2 * i + 1;
-}
-
-int right(int i)
-{
-    return 2 * i + 2;
-}
-
-void heapify_down(int h[], int i) //sink the root into the heaviest branch
-{
-    int largest_ind;
-    //swap largest child with node
-    if(left(i) < heapsize && h[left(i)] > h[i])
-    {
-        largest_ind = left(i);
-    }
-
-    else largest_ind = i;
-
-    if (right(i) < heapsize && h[right(i)] > h[largest_ind]) largest_ind = right(i);
-
-    ops += 4;
-    if(largest_ind != i)
-    {
-        std::swap(h[i], h[largest_ind]);
-        ops += 3;
-
-        heapify_down(h, largest_ind);
-    }
-}
-
-void build_max_heap_bottom_up(int h[], int n)
-{
-    heapsize = n;
-
-    for(int i = (n/2); i >= 0; i--)
-    {
-        heapify_down(h, i);
-    }
-}
-
-void heapsort(int h[], int n)
-{
-    build_max_heap_bottom_up(h, n);
-
-    for(int i = n - 1; i >= 1; i--)
-    {
-        std::swap(h[0], h[i]);
-
-        heapsize--;
-
-        heapify_down(h, 0);
-    }
-}
-
 void qSort_test()
 {
     printf("QUICKSORT TEST:\n");
     FillRandomArray(arr, 10, 0, 20, false, UNSORTED);
-    quicksort(arr, part, 0, 9, true);
+    TraceCounter tracer(10);
+    quicksort(arr, part, 0, 9, tracer);
 
     print_A(arr, 10);
 
@@ -257,7 +76,8 @@ void qSelect_test(int index)
     FillRandomArray(arr, 10, 0, 20, false, UNSORTED);
     print_A(arr, 10);
 
-    int k = quickselect(arr, 0, 9, index, true);
+    TraceCounter tracer(10);
+    int k = quickselect(arr, 0, 9, index, tracer);
 
     printf("The %dth element of the sorted array is: %d\n\n", index, k);
 }
@@ -265,6 +85,7 @@ void qSelect_test(int index)
 void avg_case(char operationsQuickSort[50], char operationsHeapSort[50])
 {
     int heap[MAX_SIZE] = {0};
+    static int input[MAX_SIZE];
 
     for(int n = 100; n <= 10000; n += 100)
     {
@@ -272,19 +93,36 @@ void avg_case(char operationsQuickSort[50], char operationsHeapSort[50])
         {
             FillRandomArray(arr, n, 0, 1000, false, UNSORTED);
             CopyArray(heap, arr, n);
-
-            ops = 0;
-            quicksort(arr, part, 0, n - 1, false);
-            p.countOperation(operationsQuickSort, n, ops);
-
-            ops = 0;
-            heapsort(heap, n);
-            p.countOperation(operationsHeapSort, n, ops);
+            CopyArray(input, arr, n);
+
+            OpCounter quick;
+            quicksort(arr, part, 0, n - 1, quick);
+            p.countOperation(operationsQuickSort, n, quick.total());
+            p.addSample(operationsQuickSort, n, quick.total()); //keeps the spread of the 5 runs
+
+            OpCounter heapOps;
+            heapsort(heap, n, heapOps, 4);
+            p.countOperation(operationsHeapSort, n, heapOps.total());
+            p.addSample(operationsHeapSort, n, heapOps.total());
+
+            //the hardware counters (cycles, instructions, misses) of the uncounted sorts, on the same input
+            NullCounter none;
+            CopyArray(arr, input, n);
+            p.startCounters(operationsQuickSort, n);
+            quicksort(arr, part, 0, n - 1, none);
+            p.stopCounters(operationsQuickSort, n);
+
+            CopyArray(heap, input, n);
+            p.startCounters(operationsHeapSort, n);
+            heapsort(heap, n, none, 4);
+            p.stopCounters(operationsHeapSort, n);
         }
     }
 
     p.divideValues(operationsQuickSort, 5);
     p.divideValues(operationsHeapSort, 5);
+    p.divideCounters(operationsQuickSort, 5);
+    p.divideCounters(operationsHeapSort, 5);
 }
 
 void eval_qsort(int c, char operationsQuickSort[50])
@@ -293,9 +131,52 @@ void eval_qsort(int c, char operationsQuickSort[50])
     {
         FillRandomArray(arr, n, 0, 1000, false, DESCENDING);
 
-        ops = 0;
-        quicksort(arr, (c == 1)? part_m: part, 0, n - 1, false);
-        p.countOperation(operationsQuickSort, n, ops);
+        OpCounter quick;
+        quicksort(arr, (c == 1)? part_m<int, OpCounter>: part<int, OpCounter>, 0, n - 1, quick);
+        p.countOperation(operationsQuickSort, n, quick.total());
+    }
+}
+
+//McIlroy's adversarial input, built against the middle pivot (c == 1) or the random pivot
+void eval_killer(int c, const char *operationsQuickSort)
+{
+    for(int n = 500; n <= 10000; n += 500)
+    {
+        FillQuicksortKiller(arr, n, [c](AdversaryItem *a, int n)
+        {
+            NullCounter none;
+            quicksort(a, (c == 1)? part_m<AdversaryItem, NullCounter>: part_rand<AdversaryItem, NullCounter>, 0, n - 1, none);
+        });
+
+        OpCounter quick;
+        quicksort(arr, (c == 1)? part_m<int, OpCounter>: part_rand<int, OpCounter>, 0, n - 1, quick);
+        p.countOperation(operationsQuickSort, n, quick.total());
+    }
+}
+
+//where the operations go, level by level: quicksort.folded (flamegraph.pl, speedscope),
+//quicksort_trace.json (chrome://tracing, Perfetto) and the call tree on stdout
+void eval_spans(int n)
+{
+    FillRandomArray(arr, n, 0, 1000, false, UNSORTED);
+    SpanCounter average(p);
+    quicksort(arr, part<int, SpanCounter>, 0, n - 1, average);
+
+    FillRandomArray(arr, n, 0, 1000, false, UNSORTED);
+    SpanCounter select(p);
+    quickselect(arr, 0, n - 1, n / 2, select);
+
+    FILE *fout = fopen("quicksort.folded", "w");
+    if(fout)
+    {
+        p.exportSpans(fout, Profiler::SPANS_FOLDED_OPS);
+        fclose(fout);
+    }
+    fout = fopen("quicksort_trace.json", "w");
+    if(fout)
+    {
+        p.exportSpans(fout, Profiler::SPANS_CHROME_TRACE);
+        fclose(fout);
     }
 }
 
@@ -303,14 +184,20 @@ int main()
 {
     avg_case("quicksort_avg", "heapsort_avg");
     p.createGroup("Comparison", "quicksort_avg", "heapsort_avg");
+    p.createGroup("IPC", "quicksort_avg_IPC", "heapsort_avg_IPC");
+    p.createGroup("LLC_misses", "quicksort_avg_LLC_misses", "heapsort_avg_LLC_misses");
     qSort_test();
     qSelect_test(5);
 
     eval_qsort(1, "quicksort_best");
     eval_qsort(0, "quicksort_worst");
+    eval_killer(1, "quicksort_killer_m");
+    eval_killer(0, "quicksort_killer_rand");
+    eval_spans(1000);
 
     p.createGroup("Quicksort", "quicksort_best", "quicksort_worst", "quicksort_avg");
     p.createGroup("Quicksort_best_case_vs_avg_case", "quicksort_best", "quicksort_avg");
+    p.createGroup("Quicksort_killer", "quicksort_worst", "quicksort_killer_m", "quicksort_killer_rand", "quicksort_avg");
 
     p.showReport();
 
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "Profiler.h"
+#include "CacheSim.h"
 #include "SLList.h"
 
 #define MAX_SIZE 100000
@@ -72,6 +73,9 @@ void array_to_SLL(int a[], int n, SLList* List)
 void heapify_down(Heap_elem h[], int i) //sink the root into the heaviest branch
 {
     int min_ind;
+    SimulateAccess(&h[i], sizeof(Heap_elem));
+    if(left(i) < heapsize) SimulateAccess(&h[left(i)], sizeof(Heap_elem));
+    if(right(i) < heapsize) SimulateAccess(&h[right(i)], sizeof(Heap_elem));
     //swap largest child with node
     if(left(i) < heapsize && h[left(i)].content < h[i].content)
     {
@@ -97,6 +101,8 @@ void heapify_up(Heap_elem h[], int i) //bubble up the index
 {
     //if parent exists, and is bigger then index, swap!
     ops += 1;
+    SimulateAccess(&h[i], sizeof(Heap_elem));
+    SimulateAccess(&h[parent(i)], sizeof(Heap_elem));
     if(parent(i) >= 0 && h[parent(i)].content > h[i].content)
     {
         ops += 3;
@@ -212,10 +218,11 @@ void test_merge()
 
 int random(int x, int y)
 {
-    return (rand() % (y - x)) + x;
+    return (int)ThreadRandom().uniform(x, y - 1);
 }
 
-void merge_k_lists(int k, int n, int flag) //k nr of lists, n length
+//with counters, the hardware counters of the merge go to its series
+void merge_k_lists(int k, int n, int flag, const char *counters = NULL) //k nr of lists, n length
 {
     generate_Lists(n, k);
 
@@ -228,6 +235,8 @@ void merge_k_lists(int k, int n, int flag) //k nr of lists, n length
         }
     }
 
+    if(counters) p.startCounters(counters, n);
+
     for(int i = 0; i < k; i++)
     {
         push_heap(h, Lists[i].first->content, i);
@@ -240,14 +249,19 @@ void merge_k_lists(int k, int n, int flag) //k nr of lists, n length
 
         if(flag) insertAtRear(&output, elem.content);
 
+        SimulateAccess(&Lists[elem.source], sizeof(SLList));
+        SimulateAccess(Lists[elem.source].first, sizeof(Node));
         deleteAtFront(&Lists[elem.source]);
 
         //if list from source is empty, go from beginning to find a list where it is not empty
         if(Lists[elem.source].first)
         {
+            SimulateAccess(Lists[elem.source].first, sizeof(Node));
             push_heap(h, Lists[elem.source].first->content, elem.source);
         }
     }
+
+    if(counters) p.stopCounters(counters, n);
 }
 
 void merge_eval(int k, char function_name[50])
@@ -257,13 +271,27 @@ void merge_eval(int k, char function_name[50])
         for(int n = 100; n <= 10000; n += 100)
         {
             ops = 0;
-            merge_k_lists(k, n, 0);
+            {
+                //the lists are new (and elsewhere in memory) every time, so the misses are averaged too
+                CacheScope cache(p, function_name, n);
+                merge_k_lists(k, n, 0);
+            }
 
             p.countOperation(function_name, n, ops);
+
+            //again without the simulator, whose work would show in the hardware counters
+            merge_k_lists(k, n, 0, function_name);
         }
     }
 
     p.divideValues(function_name, 5);
+    p.divideCounters(function_name, 5);
+
+    static const char *misses[] = { "_accesses", "_L1_misses", "_L2_misses", "_LLC_misses", "_TLB_misses" };
+    for(int i = 0; i < 5; i++)
+    {
+        p.divideValues((std::string(function_name) + misses[i]).c_str(), 5);
+    }
 }
 
 void merge_eval(char function_name[])
@@ -289,6 +317,9 @@ void evaluate()
     merge_eval(100, "one_hundred");
 
     p.createGroup("Merging_in_function_of_n", "five", "ten", "one_hundred");
+    p.createGroup("L1_misses_in_function_of_n", "five_L1_misses", "ten_L1_misses", "one_hundred_L1_misses");
+    p.createGroup("TLB_misses_in_function_of_n", "five_TLB_misses", "ten_TLB_misses", "one_hundred_TLB_misses");
+    p.createGroup("IPC_in_function_of_n", "five_IPC", "ten_IPC", "one_hundred_IPC");
 
     merge_eval("n_ten_thousand");
     p.createGroup("Merging_in_function_of_k", "n_ten_thousand");
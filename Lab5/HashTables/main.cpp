@@ -40,6 +40,8 @@ maximum efforts are miles lower than the worst case of the size of the table.
 
 int ops;
 
+Profiler p("HashTables");
+
 typedef struct node
 {
     int id;
@@ -52,9 +54,7 @@ int c1 = 13, c2 = 23;
 
 int random(int x, int y)
 {
-    srand(time(0));
-
-    return (rand() % (y - x)) + x;
+    return (int)ThreadRandom().uniform(x, y - 1);
 }
 
 int hbeta(int k)
@@ -154,6 +154,7 @@ void insert_until_fillfactor(Node* table[], int m, float fill_factor)
 
     float total_found_rate = 0;
     int n = fill_factor * TABLE_SIZE;
+    int percent = (int)(fill_factor * 100 + 0.5);
 
     int poolA[2 * n] = {0};
     int tofindindexA[m] = {0};
@@ -188,6 +189,7 @@ void insert_until_fillfactor(Node* table[], int m, float fill_factor)
                 found++;
 
                 total_effort_found += ops;
+                p.recordValue("effort_found", percent, ops);
 
                 if(ops > max_effort_found) max_effort_found = ops;
             }
@@ -195,6 +197,7 @@ void insert_until_fillfactor(Node* table[], int m, float fill_factor)
             else
             {
                 total_effort_not_found += ops;
+                p.recordValue("effort_not_found", percent, ops);
 
                 if(ops > max_effort_not_found) max_effort_not_found = ops;
             }
@@ -208,6 +211,9 @@ void insert_until_fillfactor(Node* table[], int m, float fill_factor)
     avg_effort_not_found /= 5;
 
     printf("%.2f: Avg effort found: %.3f, Avg effort not found: %.3f, Max effort found: %d, Max effort not found: %d\n", fill_factor, avg_effort_found, avg_effort_not_found, max_effort_found, max_effort_not_found);
+
+    Histogram found = p.histogram("effort_found", percent), not_found = p.histogram("effort_not_found", percent);
+    printf("      p99 effort found: %llu, p99 effort not found: %llu, p99.9 effort not found: %llu\n", found.percentile(99), not_found.percentile(99), not_found.percentile(99.9));
 }
 
 void test(int n, int m)
@@ -251,5 +257,7 @@ int main()
     insert_until_fillfactor(table, 3000, 0.99);
     //test(TABLE_SIZE, 5);
 
+    p.showReport();
+
     return 0;
 }
@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "Profiler.h"
+#define PROFILER_TRACK_ALLOCATIONS
+#include "Allocations.h"
 
 #define MAX_SIZE 100000
 
@@ -177,9 +179,7 @@ Node* OS_Delete(Node* root, int i)
 
 int random(int x, int y)
 {
-    srand(time(0));
-
-    return (rand() % (y - x)) + x;
+    return (int)ThreadRandom().uniform(x, y - 1);
 }
 
 void test()
@@ -234,7 +234,10 @@ void eval()
 
             FillRandomArray(arr, n + 1, 0, 99999, true, ASCENDING);
 
-            root = build_PBT(arr, 0, n - 1);
+            {
+                AllocationScope allocations(p, "build_PBT", n); //a malloc per node
+                root = build_PBT(arr, 0, n - 1);
+            }
 
             sel_ops = del_ops = 0;
 
@@ -253,6 +256,9 @@ void eval()
 
     p.divideValues("OS_Select", 5);
     p.divideValues("OS_Delete", 5);
+    p.divideValues("build_PBT_allocations", 5);
+    p.divideValues("build_PBT_allocated_bytes", 5);
+    p.divideValues("build_PBT_peak_bytes", 5);
 
     p.createGroup("OS_Operations", "OS_Select", "OS_Delete");
     p.showReport();
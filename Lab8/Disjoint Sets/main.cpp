@@ -128,7 +128,7 @@ void swap_edges(Edge* a, Edge* b)
 
 int part_rand(Edge a[], int l, int r)
 {
-    int pivot = rand() % (r - l) + l;
+    int pivot = (int)ThreadRandom().uniform(l, r - 1);
 
     swap_edges(&a[pivot], &a[r]); //std::swap(a[pivot], a[r]); //swap pivot with last element, now a[r] is the pivot
 
@@ -204,7 +204,7 @@ void union_set(Node* x, Node* y)
 
 int random(int x, int y)
 {
-    return (rand() % (y - x)) + x;
+    return (int)ThreadRandom().uniform(x, y - 1);
 }
 
 void sets_demo()
@@ -423,8 +423,6 @@ void demo()
 
 int main()
 {
-    srand(time(0));
-
     demo();
     eval_kruskal();
     p.showReport();
@@ -13,6 +13,24 @@
 #   include <Shellapi.h>
 #endif
 
+#if defined(__linux__) && !defined(PROFILER_NO_PERF_EVENTS)
+#   define PROFILER_PERF_EVENTS 1
+#   include <unistd.h>
+#   include <errno.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <linux/perf_event.h>
+#endif
+
+#ifdef _MSC_VER
+#   include <io.h>
+#else
+#   include <unistd.h>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -20,10 +38,18 @@
 
 #include <typeinfo>
 #include <map>
+#include <set>
 #include <vector>
 #include <algorithm>
 #include <functional>
 #include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <limits>
+#include <math.h>
 
 namespace HtmlGen{
 const char htmlFirst[] = {
@@ -11087,267 +11113,3338 @@ const char htmlLast[] = {
 0x20, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x2b, 0x20, 0x22, 0x5f, 0x73, 0x5f, 0x22, 
 0x20, 0x2b, 0x20, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x63, 0x65, 0x29, 0x2c, 0x20, 0x73, 0x65, 
 0x72, 0x69, 0x65, 0x73, 0x29, 0x3b, 0x0a, 0x09, 0x09, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x09, 0x09, 
-0x7d, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x7d, 0x0a, 0x09, 0x0a, 0x7d, 0x29, 0x3b, 0x0a, 0x3c, 
-0x2f, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x3e, 0x0a, 0x0a, 0x20, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 
-0x79, 0x3e, 0x0a, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a
+0x7d, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x7d, 0x0a, 0x09, 0x0a, 0x09, 0x2f, 0x2f, 0x6c, 0x61, 
+0x73, 0x74, 0x2c, 0x20, 0x74, 0x68, 0x65, 0x20, 0x67, 0x72, 0x6f, 0x77, 0x74, 0x68, 0x20, 0x6d, 
+0x6f, 0x64, 0x65, 0x6c, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x66, 0x69, 0x74, 0x73, 0x20, 0x65, 
+0x76, 0x65, 0x72, 0x79, 0x20, 0x73, 0x65, 0x72, 0x69, 0x65, 0x73, 0x20, 0x62, 0x65, 0x73, 0x74, 
+0x3a, 0x20, 0x61, 0x20, 0x2b, 0x20, 0x62, 0x20, 0x2a, 0x20, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x28, 
+0x6e, 0x29, 0x2c, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65, 0x20, 0x70, 0x6f, 0x77, 0x65, 
+0x72, 0x20, 0x6c, 0x61, 0x77, 0x0a, 0x09, 0x69, 0x66, 0x28, 0x21, 0x69, 0x73, 0x45, 0x6d, 0x70, 
+0x74, 0x79, 0x28, 0x64, 0x61, 0x74, 0x61, 0x5b, 0x22, 0x66, 0x69, 0x74, 0x73, 0x22, 0x5d, 0x29, 
+0x29, 0x7b, 0x0a, 0x09, 0x09, 0x62, 0x6f, 0x64, 0x79, 0x2e, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 
+0x28, 0x22, 0x3c, 0x68, 0x31, 0x3e, 0x47, 0x72, 0x6f, 0x77, 0x74, 0x68, 0x20, 0x6d, 0x6f, 0x64, 
+0x65, 0x6c, 0x73, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x5c, 0x6e, 0x22, 0x29, 0x3b, 0x0a, 0x09, 0x09, 
+0x76, 0x61, 0x72, 0x20, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x3d, 0x20, 0x22, 0x3c, 0x74, 0x61, 
+0x62, 0x6c, 0x65, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x67, 0x72, 0x69, 0x64, 0x74, 
+0x61, 0x62, 0x6c, 0x65, 0x27, 0x20, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x3d, 0x27, 0x77, 0x69, 0x64, 
+0x74, 0x68, 0x3a, 0x20, 0x61, 0x75, 0x74, 0x6f, 0x27, 0x3e, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 
+0x68, 0x3e, 0x73, 0x65, 0x72, 0x69, 0x65, 0x73, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 
+0x3e, 0x62, 0x65, 0x73, 0x74, 0x20, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 
+0x3c, 0x74, 0x68, 0x3e, 0x61, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x62, 0x3c, 
+0x2f, 0x74, 0x68, 0x3e, 0x22, 0x3b, 0x0a, 0x09, 0x09, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x2b, 
+0x3d, 0x20, 0x22, 0x3c, 0x74, 0x68, 0x3e, 0x52, 0x3c, 0x73, 0x75, 0x70, 0x3e, 0x32, 0x3c, 0x2f, 
+0x73, 0x75, 0x70, 0x3e, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x70, 0x6f, 0x77, 
+0x65, 0x72, 0x20, 0x6c, 0x61, 0x77, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x52, 
+0x3c, 0x73, 0x75, 0x70, 0x3e, 0x32, 0x3c, 0x2f, 0x73, 0x75, 0x70, 0x3e, 0x3c, 0x2f, 0x74, 0x68, 
+0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x22, 0x3b, 0x0a, 0x09, 0x09, 0x66, 0x6f, 0x72, 0x28, 0x76, 
+0x61, 0x72, 0x20, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x63, 0x65, 0x20, 0x69, 0x6e, 0x20, 0x64, 
+0x61, 0x74, 0x61, 0x5b, 0x22, 0x66, 0x69, 0x74, 0x73, 0x22, 0x5d, 0x29, 0x7b, 0x0a, 0x09, 0x09, 
+0x09, 0x76, 0x61, 0x72, 0x20, 0x66, 0x69, 0x74, 0x20, 0x3d, 0x20, 0x64, 0x61, 0x74, 0x61, 0x5b, 
+0x22, 0x66, 0x69, 0x74, 0x73, 0x22, 0x5d, 0x5b, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x63, 0x65, 
+0x5d, 0x3b, 0x0a, 0x09, 0x09, 0x09, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x2b, 0x3d, 0x20, 0x22, 
+0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e, 0x22, 0x20, 0x2b, 0x20, 0x73, 0x65, 0x71, 0x75, 
+0x65, 0x6e, 0x63, 0x65, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x74, 0x64, 
+0x3e, 0x22, 0x20, 0x2b, 0x20, 0x66, 0x69, 0x74, 0x5b, 0x22, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x22, 
+0x5d, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x22, 0x3b, 0x0a, 0x09, 0x09, 0x09, 
+0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x2b, 0x3d, 0x20, 0x22, 0x3c, 0x74, 0x64, 0x3e, 0x22, 0x20, 
+0x2b, 0x20, 0x66, 0x69, 0x74, 0x5b, 0x22, 0x61, 0x22, 0x5d, 0x2e, 0x74, 0x6f, 0x50, 0x72, 0x65, 
+0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x28, 0x34, 0x29, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 
+0x64, 0x3e, 0x3c, 0x74, 0x64, 0x3e, 0x22, 0x20, 0x2b, 0x20, 0x66, 0x69, 0x74, 0x5b, 0x22, 0x62, 
+0x22, 0x5d, 0x2e, 0x74, 0x6f, 0x50, 0x72, 0x65, 0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x28, 0x34, 
+0x29, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x22, 0x3b, 0x0a, 0x09, 0x09, 0x09, 
+0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x2b, 0x3d, 0x20, 0x22, 0x3c, 0x74, 0x64, 0x3e, 0x22, 0x20, 
+0x2b, 0x20, 0x66, 0x69, 0x74, 0x5b, 0x22, 0x72, 0x32, 0x22, 0x5d, 0x2e, 0x74, 0x6f, 0x46, 0x69, 
+0x78, 0x65, 0x64, 0x28, 0x34, 0x29, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x22, 
+0x3b, 0x0a, 0x09, 0x09, 0x09, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x2b, 0x3d, 0x20, 0x22, 0x3c, 
+0x74, 0x64, 0x3e, 0x22, 0x20, 0x2b, 0x20, 0x66, 0x69, 0x74, 0x5b, 0x22, 0x63, 0x6f, 0x65, 0x66, 
+0x66, 0x69, 0x63, 0x69, 0x65, 0x6e, 0x74, 0x22, 0x5d, 0x2e, 0x74, 0x6f, 0x50, 0x72, 0x65, 0x63, 
+0x69, 0x73, 0x69, 0x6f, 0x6e, 0x28, 0x34, 0x29, 0x20, 0x2b, 0x20, 0x22, 0x20, 0x6e, 0x3c, 0x73, 
+0x75, 0x70, 0x3e, 0x22, 0x20, 0x2b, 0x20, 0x66, 0x69, 0x74, 0x5b, 0x22, 0x65, 0x78, 0x70, 0x6f, 
+0x6e, 0x65, 0x6e, 0x74, 0x22, 0x5d, 0x2e, 0x74, 0x6f, 0x46, 0x69, 0x78, 0x65, 0x64, 0x28, 0x33, 
+0x29, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x73, 0x75, 0x70, 0x3e, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 
+0x22, 0x3b, 0x0a, 0x09, 0x09, 0x09, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x2b, 0x3d, 0x20, 0x22, 
+0x3c, 0x74, 0x64, 0x3e, 0x22, 0x20, 0x2b, 0x20, 0x66, 0x69, 0x74, 0x5b, 0x22, 0x70, 0x6f, 0x77, 
+0x65, 0x72, 0x5f, 0x72, 0x32, 0x22, 0x5d, 0x2e, 0x74, 0x6f, 0x46, 0x69, 0x78, 0x65, 0x64, 0x28, 
+0x34, 0x29, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 
+0x22, 0x3b, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x09, 0x62, 0x6f, 0x64, 0x79, 0x2e, 0x61, 0x70, 
+0x70, 0x65, 0x6e, 0x64, 0x28, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 
+0x74, 0x61, 0x62, 0x6c, 0x65, 0x3e, 0x22, 0x29, 0x3b, 0x0a, 0x09, 0x7d, 0x0a, 0x7d, 0x29, 0x3b, 
+0x0a, 0x3c, 0x2f, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x3e, 0x0a, 0x0a, 0x20, 0x3c, 0x2f, 0x62, 
+0x6f, 0x64, 0x79, 0x3e, 0x0a, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a
 };
 };
 
-class Profiler{
+/**
+* hardware performance counters, read through perf_event_open on Linux.
+* on other systems, or when the kernel does not allow it (perf_event_paranoid,
+* containers, virtual machines), available() returns false and nothing gets recorded.
+* cycles lead a group that the other counters join, so that all of them count over the same
+* intervals when the kernel multiplexes them and derived values (IPC) stay consistent;
+* a counter that can not join the group is opened (and scaled) on its own
+*/
+class PerfCounters{
 public:
-	/**
-	* maximum lenght for any string that this class should receive
-	*/
-	static const int MAX_NAME_LEN = 128;
+	enum CounterId { CYCLES=0, INSTRUCTIONS, L1_MISSES, LLC_MISSES, BRANCH_MISSES, DTLB_MISSES, COUNTER_COUNT };
 
-	/**
-	* constructs a new profiler with the given title
-	*/
-	Profiler(const char* givenTitle = NULL){
-		reset(givenTitle);
+	PerfCounters() : groupSize(0), opened(false), usable(false){
+		for(int i=0; i<COUNTER_COUNT; ++i){
+			fds[i] = -1;
+			grouped[i] = false;
+			values[i] = 0;
+			valid[i] = false;
+		}
 	}
 
-	~Profiler(){
+	~PerfCounters(){
+#ifdef PROFILER_PERF_EVENTS
+		//the members before the leader
+		for(int i=COUNTER_COUNT-1; i>=0; --i){
+			if(fds[i] != -1){
+				close(fds[i]);
+			}
+		}
+#endif
 	}
 
-    /**
-    * increases the count for operation name, at the specified size
-    */
-    void reset(const char *newTitle = NULL){
-        if(opcountMap.size() != 0){
-            showReport();
-        }
-        title = newTitle? newTitle: "Title";
-        groups.clear();
-        opcountMap.clear();
-    }
+	/**
+	* name of the counter, used as suffix for the series
+	*/
+	static const char *counterName(int id){
+		static const char *names[COUNTER_COUNT] = {
+			"cycles", "instructions", "L1_misses", "LLC_misses", "branch_misses", "dTLB_misses"
+		};
+		return names[id];
+	}
 
 	/**
-	* increases the count for operation name, at the specified size
+	* opens the counters the first time it is called; false if none of them could be opened
 	*/
-	void countOperation(const char *name, int size, int increment=1){
-		opcountMap[name][size] += increment;
+	bool available(){
+		if(!opened){
+			open();
+		}
+		return usable;
 	}
 
 	/**
-	* creates a new group from the given members
-	* the members will be displayed in the same chart
+	* resets and enables every open counter (the group through its leader)
 	*/
-	void createGroup(const char *groupName, const char *member1, const char *member2 = NULL,
-						const char *member3 = NULL, const char *member4 = NULL,
-						const char *member5 = NULL, const char *member6 = NULL,
-						const char *member7 = NULL, const char *member8 = NULL,
-						const char *member9 = NULL, const char *member10 = NULL){
-		groups[groupName] = std::vector<std::string>();
-		//this is a bad coding style
-		//kids, don't do this at home
-#define ADD_MEMBER(member) if(member) {groups[groupName].push_back(member);}
-		ADD_MEMBER(member1);
-		ADD_MEMBER(member2);
-		ADD_MEMBER(member3);
-		ADD_MEMBER(member4);
-		ADD_MEMBER(member5);
-		ADD_MEMBER(member6);
-		ADD_MEMBER(member7);
-		ADD_MEMBER(member8);
-		ADD_MEMBER(member9);
-		ADD_MEMBER(member10);
-#undef ADD_MEMBER
+	void start(){
+#ifdef PROFILER_PERF_EVENTS
+		for(int i=0; i<COUNTER_COUNT; ++i){
+			if(fds[i] != -1 && (!grouped[i] || i == CYCLES)){
+				unsigned long flags = grouped[i]? PERF_IOC_FLAG_GROUP: 0;
+				ioctl(fds[i], PERF_EVENT_IOC_RESET, flags);
+				ioctl(fds[i], PERF_EVENT_IOC_ENABLE, flags);
+			}
+		}
+#endif
 	}
 
 	/**
-	* creates a new series, by summing the given ones
+	* disables the counters and reads them, scaling the values if the kernel had to multiplex them:
+	* the group once, by the time it ran, the counters outside of it each by their own
 	*/
-	void addSeries(const char *newName, const char *series1, const char *series2){
-		if (opcountMap.find(series1) != opcountMap.end() &&
-			opcountMap.find(series2) != opcountMap.end()){
-				OpcountSequence::const_iterator it1, it2;
-				opcountMap[newName] = OpcountSequence();
-				for (it1 = opcountMap[series1].begin(); it1 != opcountMap[series1].end(); ++it1){
-					it2 = opcountMap[series2].find(it1->first);
-					if(it2 != opcountMap[series2].end()){
-						opcountMap[newName][it1->first] = it1->second + it2->second;
-					}else{
-						opcountMap[newName][it1->first] = it1->second;
-					}
+	void stop(){
+#ifdef PROFILER_PERF_EVENTS
+		int i;
+		for(i=0; i<COUNTER_COUNT; ++i){
+			if(fds[i] != -1 && (!grouped[i] || i == CYCLES)){
+				ioctl(fds[i], PERF_EVENT_IOC_DISABLE, grouped[i]? PERF_IOC_FLAG_GROUP: 0);
+			}
+			valid[i] = false;
+		}
+		if(groupSize > 0){
+			unsigned long long data[3 + COUNTER_COUNT]; //count, time enabled, time running, the values in group order
+			ssize_t size = (ssize_t)((3 + groupSize) * sizeof(unsigned long long));
+			if(read(fds[CYCLES], data, size) == size && data[0] == (unsigned long long)groupSize && data[2] != 0){
+				for(i=0; i<groupSize; ++i){
+					store(groupOrder[i], data[3 + i], data[1], data[2]);
 				}
+			}
+		}
+		for(i=0; i<COUNTER_COUNT; ++i){
+			unsigned long long data[3]; //value, time enabled, time running
+			if(fds[i] == -1 || grouped[i] || read(fds[i], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0){
+				continue;
+			}
+			store(i, data[0], data[1], data[2]);
 		}
+#endif
 	}
 
-    /**
-    * divides the values in a series
-    */
-	void divideValues(const char *series, unsigned int divisor) {
-		if (opcountMap.find(series) != opcountMap.end() && divisor != 0) {
-			OpcountSequence::iterator it;
-			for (it = opcountMap[series].begin(); it != opcountMap[series].end(); ++it) {
-				it->second /= divisor;
+	bool has(int id) const { return valid[id]; }
+	unsigned long long get(int id) const { return values[id]; }
+
+private:
+	int fds[COUNTER_COUNT];
+	bool grouped[COUNTER_COUNT];
+	int groupOrder[COUNTER_COUNT];
+	int groupSize;
+	unsigned long long values[COUNTER_COUNT];
+	bool valid[COUNTER_COUNT];
+	bool opened, usable;
+
+	PerfCounters(const PerfCounters&);
+	PerfCounters &operator=(const PerfCounters&);
+
+	void store(int id, unsigned long long value, unsigned long long enabled, unsigned long long running){
+		values[id] = value;
+		if(running < enabled){
+			values[id] = (unsigned long long)((double)value * enabled / running);
+		}
+		valid[id] = true;
+	}
+
+	void open(){
+		opened = true;
+#ifdef PROFILER_PERF_EVENTS
+		const unsigned long long cacheMiss = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+		unsigned int types[COUNTER_COUNT] = {
+			PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+			PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+		};
+		unsigned long long configs[COUNTER_COUNT] = {
+			PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_L1D | cacheMiss,
+			PERF_COUNT_HW_CACHE_LL | cacheMiss, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_DTLB | cacheMiss
+		};
+		int lastError = 0;
+		for(int i=0; i<COUNTER_COUNT; ++i){
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = types[i];
+			attr.config = configs[i];
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			int leader = fds[CYCLES];
+			if(i == CYCLES || leader != -1){
+				//the leader reads the whole group
+				attr.read_format |= PERF_FORMAT_GROUP;
+				fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, i == CYCLES? -1: leader, 0);
+				if(fds[i] != -1){
+					grouped[i] = true;
+					groupOrder[groupSize++] = i;
+				}
+			}
+			if(fds[i] == -1 && i != CYCLES){
+				attr.read_format &= ~(unsigned long long)PERF_FORMAT_GROUP;
+				fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+			}
+			if(fds[i] == -1){
+				lastError = errno;
+			}else{
+				usable = true;
+			}
+		}
+		if(!usable){
+			fprintf(stderr, "[Profiler] hardware counters not available (%s), skipping them\n", strerror(lastError));
+		}
+#endif
+	}
+};
+
+/**
+* statistics of the samples recorded for one series at one size
+*/
+struct SampleSummary{
+	size_t count;
+	double mean, median, stddev, min, max;
+	double p5, p95;
+	//95% bootstrap confidence interval of the mean
+	double ciLow, ciHigh;
+};
+
+/**
+* value at the given percentile (0..100) of sorted samples, interpolating between the closest ranks
+*/
+inline double Percentile(const std::vector<double> &sorted, double percentile){
+	if(sorted.empty()){
+		return 0.0;
+	}
+	double rank = percentile / 100.0 * (sorted.size() - 1);
+	size_t below = (size_t)rank;
+	if(below + 1 >= sorted.size()){
+		return sorted.back();
+	}
+	return sorted[below] + (rank - below) * (sorted[below + 1] - sorted[below]);
+}
+
+/**
+* computes the summary of the samples (which get sorted).
+* the confidence interval comes from resampling the samples bootstrapRounds times,
+* with a fixed seed, so the same samples always give the same interval
+*/
+inline SampleSummary SummarizeSamples(std::vector<double> &samples, int bootstrapRounds = 1000){
+	SampleSummary summary;
+	memset(&summary, 0, sizeof(summary));
+	size_t n = samples.size(), i;
+	summary.count = n;
+	if(n == 0){
+		return summary;
+	}
+	std::sort(samples.begin(), samples.end());
+	double sum = 0.0, squares = 0.0;
+	for(i=0; i<n; ++i){
+		sum += samples[i];
+	}
+	summary.mean = sum / n;
+	for(i=0; i<n; ++i){
+		squares += (samples[i] - summary.mean) * (samples[i] - summary.mean);
+	}
+	summary.stddev = n > 1? sqrt(squares / (n - 1)): 0.0;
+	summary.min = samples[0];
+	summary.max = samples[n - 1];
+	summary.median = Percentile(samples, 50);
+	summary.p5 = Percentile(samples, 5);
+	summary.p95 = Percentile(samples, 95);
+
+	summary.ciLow = summary.ciHigh = summary.mean;
+	if(n > 1 && bootstrapRounds > 0){
+		std::mt19937 engine(12345);
+		std::uniform_int_distribution<size_t> pick(0, n - 1);
+		std::vector<double> means(bootstrapRounds);
+		for(int round=0; round<bootstrapRounds; ++round){
+			double resampled = 0.0;
+			for(i=0; i<n; ++i){
+				resampled += samples[pick(engine)];
 			}
+			means[round] = resampled / n;
 		}
+		std::sort(means.begin(), means.end());
+		summary.ciLow = Percentile(means, 2.5);
+		summary.ciHigh = Percentile(means, 97.5);
+	}
+	return summary;
+}
+
+/**
+* an append-only log of the results, so that a long sweep survives a crash and can be resumed
+* (see Profiler::attachLog and SweepRunner::checkpoint). the file is "PRFL", u32 version (1),
+* then records of u8 type, u8 0, u16 name length, i32 size, 8 byte value and the name, in
+* the byte order of the machine. a record is complete once its type is written, which is
+* done last, so a log cut by a crash ends at the first zero type.
+* the file is memory mapped and grown by doubling; on Windows it is appended to with stdio
+*/
+class ResultLog{
+public:
+	enum RecordType { RECORD_END, RECORD_COUNT, RECORD_REAL, RECORD_TIME, RECORD_SAMPLE, RECORD_CELL, RECORD_FLUSH };
+
+	struct Record{
+		int type;
+		std::string name;
+		int size;
+		unsigned long long value;
+	};
+
+	ResultLog() : length(0), capacity(0) {
+#ifdef _MSC_VER
+		file = NULL;
+#else
+		fd = -1;
+		base = NULL;
+#endif
+	}
+
+	~ResultLog(){
+		close();
 	}
 
 	/**
-	* creates and shows the report
+	* opens fileName, creating it if needed; the records already in it are kept in
+	* recovered(). returns false if the file can not be opened or is not a log
 	*/
-	int showReport(){
-		FILE *fout = NULL;
-		bool hasData, hasSequences;
-		char reportName[200];
-		time_t crtTime = time(0);
-		struct tm now;
+	bool open(const char *fileName){
+		close();
+		std::string text;
 #ifdef _MSC_VER
-		localtime_s(&now, &crtTime);
+		file = fopen(fileName, "r+b");
+		if(file == NULL){
+			file = fopen(fileName, "w+b");
+		}
+		if(file == NULL){
+			return false;
+		}
+		char buffer[1 << 16];
+		size_t count;
+		while((count = fread(buffer, 1, sizeof(buffer), file)) > 0){
+			text.append(buffer, count);
+		}
+		capacity = text.size();
 #else
-        now = *localtime(&crtTime);
+		fd = ::open(fileName, O_RDWR | O_CREAT, 0644);
+		struct stat status;
+		if(fd < 0 || fstat(fd, &status) != 0 || !reserve(status.st_size > 0? (size_t)status.st_size: HEADER_SIZE)){
+			close();
+			return false;
+		}
+		text.assign(base, status.st_size);
 #endif
+		if(text.empty()){
+			unsigned int version = VERSION;
+			char header[HEADER_SIZE];
+			memcpy(header, "PRFL", 4);
+			memcpy(header + 4, &version, 4);
+			write(header, HEADER_SIZE);
+		}else if(!parse(text)){
+			close();
+			return false;
+		}else{
+			length = text.size();
+		}
+		return true;
+	}
 
+	/**
+	* closes the log; the mapped file is cut to the records written
+	*/
+	void close(){
 #ifdef _MSC_VER
-		_snprintf_s(
+		if(file != NULL){
+			fclose(file);
+			file = NULL;
+		}
 #else
-        snprintf(
+		if(base != NULL){
+			munmap(base, capacity);
+			base = NULL;
+		}
+		if(fd >= 0){
+			if(length > 0 && ftruncate(fd, length) != 0){
+				length = 0;
+			}
+			::close(fd);
+			fd = -1;
+		}
 #endif
-                            reportName, sizeof(reportName), 
-                            "report-%s-%04d%02d%02d-%02d%02d%02d.html", 
-							title.c_str(),
-							now.tm_year + 1900,
-							now.tm_mon + 1,
-							now.tm_mday,
-							now.tm_hour,
-							now.tm_min,
-							now.tm_sec
-		);
+		length = capacity = 0;
+		recoveredRecords.clear();
+		cells.clear();
+	}
+
+	bool isOpen() const{
 #ifdef _MSC_VER
-		fopen_s(&fout, reportName, "wb");
+		return file != NULL;
 #else
-		fout = fopen(reportName, "wb");
+		return base != NULL;
 #endif
-		fwrite(HtmlGen::htmlFirst, 1, sizeof(HtmlGen::htmlFirst)/sizeof(HtmlGen::htmlFirst[0]), fout);
+	}
 
-		//first, show the operation counters
-		fprintf(fout, "{\n\t\"opcount\": {\n");
-		OpcountMap::const_iterator oit1;
-		OpcountSequence::const_iterator oit2;
-		hasSequences = false;
-		for(oit1 = opcountMap.begin(); oit1 != opcountMap.end(); ++oit1){
-			hasSequences = true;
-			hasData = false;
-			fprintf(fout, "\t\t\"");
-			print_modified(fout, oit1->first.c_str());
-			fprintf(fout, "\": [");
-			for(oit2 = oit1->second.begin(); oit2 != oit1->second.end(); ++oit2){
-				hasData = true;
-				fprintf(fout, "[%d, %u], ", oit2->first, oit2->second);
-			}
-			if(hasData){
-				fseek(fout, -2, SEEK_CUR);
-			}
-			fprintf(fout, "],\n");
-		}
-		if(hasSequences){
-			fseek(fout, -(int)(strlen("\n") + 1), SEEK_CUR);
-			fprintf(fout, "\n");
-		}
-		
-        fprintf(fout, "\t},\n\t\"groups\": {\n");
-		//next show the groups
-		hasSequences = false;
-		GroupMap::const_iterator git1;
-		std::vector<std::string>::const_iterator git2;
-		for(git1 = groups.begin(); git1 != groups.end(); ++git1){
-			hasSequences = true;
-			hasData = false;
-			fprintf(fout, "\t\t\"");
-			print_modified(fout, git1->first.c_str());
-			fprintf(fout, "\": [");
-			for(git2 = git1->second.begin(); git2 != git1->second.end(); ++git2){
-				hasData = true;
-				fprintf(fout, "\"");
-				print_modified(fout, git2->c_str());
-				fprintf(fout, "\", ");
-			}
-			if(hasData){
-				fseek(fout, -2, SEEK_CUR);
-			}
-			fprintf(fout, "],\n");
+	/**
+	* the records found in the file when it was opened
+	*/
+	const std::vector<Record> &recovered() const { return recoveredRecords; }
+
+	void append(int type, const std::string &name, int size, unsigned long long value){
+		unsigned short nameLength = (unsigned short)(name.size() < 0xFFFF? name.size(): 0xFFFF);
+		char record[RECORD_SIZE];
+		record[0] = 0;
+		record[1] = 0;
+		memcpy(record + 2, &nameLength, 2);
+		memcpy(record + 4, &size, 4);
+		memcpy(record + 8, &value, 8);
+		size_t start = length;
+		if(!write(record, RECORD_SIZE) || !write(name.data(), nameLength)){
+			return;
 		}
-		if(hasSequences){
-			fseek(fout, -(int)(strlen("\n") + 1), SEEK_CUR);
-			fprintf(fout, "\n");
+		char kind = (char)type;
+		overwrite(start, &kind, 1);
+		if(type == RECORD_CELL){
+			cells.insert(CellKey(name, std::make_pair(size, (int)value)));
 		}
-		fprintf(fout, "\t}\n}\n");
-		fwrite(HtmlGen::htmlLast, 1, sizeof(HtmlGen::htmlLast)/sizeof(HtmlGen::htmlLast[0]), fout);
-		fclose(fout);
+	}
+
+	/**
+	* true if the log has the cell (size, repetition) of sweep as finished
+	*/
+	bool finished(const std::string &sweep, int size, int repetition) const{
+		return cells.find(CellKey(sweep, std::make_pair(size, repetition))) != cells.end();
+	}
 
+	/**
+	* asks the system to write the log back to the disk, without waiting for it
+	*/
+	void sync(){
 #ifdef _MSC_VER
-		ShellExecuteA(NULL, "open", reportName, NULL, NULL, SW_SHOW);
+		if(file != NULL){
+			fflush(file);
+		}
+#else
+		if(base != NULL){
+			msync(base, capacity, MS_ASYNC);
+		}
 #endif
-		return 0;
 	}
 
 private:
-	typedef unsigned int OPCOUNT_MEASURE;
+	static const unsigned int VERSION = 1;
+	static const size_t HEADER_SIZE = 8;
+	static const size_t RECORD_SIZE = 16;
+	static const size_t INITIAL_CAPACITY = 1 << 20;
 
-	typedef std::map<int, OPCOUNT_MEASURE> OpcountSequence;
-	typedef std::map<std::string, OpcountSequence> OpcountMap;
+	typedef std::pair<std::string, std::pair<int, int> > CellKey;
 
-	typedef std::map<std::string, std::vector<std::string> > GroupMap;
+	size_t length, capacity;
+	std::vector<Record> recoveredRecords;
+	std::set<CellKey> cells;
+#ifdef _MSC_VER
+	FILE *file;
+#else
+	int fd;
+	char *base;
 
-public:
-	class OperationCounter{
-		OpcountSequence::iterator ptrInMap;
-		Profiler &profiler;
-		friend class Profiler;
-		OperationCounter(Profiler &prof, const char *name, int size) : profiler(prof) {
-			profiler.opcountMap[name][size]; // force creation
-			ptrInMap = profiler.opcountMap[name].find(size);
+	/**
+	* grows the file and its mapping to hold at least needed bytes
+	*/
+	bool reserve(size_t needed){
+		if(base != NULL && needed <= capacity){
+			return true;
 		}
-	  public:
-		void count(int increment=1) { ptrInMap->second += increment; }
-		int get() const { return ptrInMap->second; }
-	};
-	
-	OperationCounter createOperation(const char *name, int size) {
-		return OperationCounter(*this, name, size);
+		size_t newCapacity = capacity > 0? capacity: INITIAL_CAPACITY;
+		while(newCapacity < needed){
+			newCapacity *= 2;
+		}
+		struct stat status;
+		if(fstat(fd, &status) != 0 || ((size_t)status.st_size < newCapacity && ftruncate(fd, newCapacity) != 0)){
+			return false;
+		}
+		if(base != NULL){
+			munmap(base, capacity);
+		}
+		void *mapping = mmap(NULL, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if(mapping == MAP_FAILED){
+			base = NULL;
+			capacity = 0;
+			return false;
+		}
+		base = (char*)mapping;
+		capacity = newCapacity;
+		return true;
 	}
+#endif
 
-private:
-	std::string title;
-	OpcountMap opcountMap;
-	GroupMap groups;
+	bool write(const char *data, size_t count){
+#ifdef _MSC_VER
+		if(file == NULL || fseek(file, (long)length, SEEK_SET) != 0 || fwrite(data, 1, count, file) != count){
+			return false;
+		}
+#else
+		if(!reserve(length + count)){
+			return false;
+		}
+		memcpy(base + length, data, count);
+#endif
+		length += count;
+		return true;
+	}
 
-	void print_modified(FILE *f, const char *str){
-		int i = 0;
-		while(str[i] != 0){
-			if(isalnum(str[i]) || str[i] == '_'){
-				fprintf(f, "%c", str[i]);
-			}else{
-				fprintf(f, "_");
+	void overwrite(size_t offset, const char *data, size_t count){
+#ifdef _MSC_VER
+		if(fseek(file, (long)offset, SEEK_SET) == 0){
+			fwrite(data, 1, count, file);
+		}
+#else
+		memcpy(base + offset, data, count);
+#endif
+	}
+
+	/**
+	* reads the records of text and leaves in text only the part to keep (up to the first incomplete record)
+	*/
+	bool parse(std::string &text){
+		unsigned int version = 0;
+		if(text.size() < HEADER_SIZE || text.compare(0, 4, "PRFL") != 0){
+			return false;
+		}
+		memcpy(&version, text.data() + 4, 4);
+		if(version != VERSION){
+			return false;
+		}
+		size_t offset = HEADER_SIZE;
+		while(offset + RECORD_SIZE <= text.size() && text[offset] != RECORD_END){
+			Record record;
+			unsigned short nameLength;
+			record.type = (unsigned char)text[offset];
+			memcpy(&nameLength, text.data() + offset + 2, 2);
+			memcpy(&record.size, text.data() + offset + 4, 4);
+			memcpy(&record.value, text.data() + offset + 8, 8);
+			if(offset + RECORD_SIZE + nameLength > text.size()){
+				break;
 			}
-			++i;
+			record.name.assign(text.data() + offset + RECORD_SIZE, nameLength);
+			if(record.type == RECORD_CELL){
+				cells.insert(CellKey(record.name, std::make_pair(record.size, (int)record.value)));
+			}
+			recoveredRecords.push_back(record);
+			offset += RECORD_SIZE + nameLength;
+		}
+		text.resize(offset);
+		return true;
+	}
+};
+
+/**
+* a log-bucketed histogram of non negative integers (HDR style): the values below 128 have a
+* bucket each, and above that every power of two is split into 64 buckets, so a value is known
+* within 1/64 (1.6%) whatever its magnitude. recording is an index computation and an increment;
+* histograms of different threads merge by adding their buckets
+*/
+class Histogram{
+public:
+	Histogram() : total(0), sum(0.0), largest(0), smallest(0) {}
+
+	void record(unsigned long long value, unsigned long long count = 1){
+		size_t index = indexOf(value);
+		if(index >= counts.size()){
+			counts.resize(index + 1, 0);
+		}
+		counts[index] += count;
+		if(total == 0 || value < smallest){
+			smallest = value;
+		}
+		if(value > largest){
+			largest = value;
+		}
+		total += count;
+		sum += (double)value * count;
+	}
+
+	void merge(const Histogram &other){
+		if(other.total == 0){
+			return;
+		}
+		if(other.counts.size() > counts.size()){
+			counts.resize(other.counts.size(), 0);
+		}
+		for(size_t i=0; i<other.counts.size(); ++i){
+			counts[i] += other.counts[i];
+		}
+		if(total == 0 || other.smallest < smallest){
+			smallest = other.smallest;
+		}
+		if(other.largest > largest){
+			largest = other.largest;
+		}
+		total += other.total;
+		sum += other.sum;
+	}
+
+	void clear(){
+		counts.clear();
+		total = 0;
+		sum = 0.0;
+		largest = smallest = 0;
+	}
+
+	bool empty() const { return total == 0; }
+	unsigned long long count() const { return total; }
+	unsigned long long min() const { return smallest; }
+	unsigned long long max() const { return largest; }
+	double mean() const { return total? sum / total: 0.0; }
+
+	/**
+	* the smallest value v such that pct percent of the values are <= v
+	* (up to the width of its bucket; never above the largest value recorded)
+	*/
+	unsigned long long percentile(double pct) const{
+		if(total == 0){
+			return 0;
+		}
+		unsigned long long rank = (unsigned long long)ceil(pct / 100.0 * total);
+		if(rank < 1){
+			rank = 1;
+		}
+		unsigned long long seen = 0;
+		for(size_t i=0; i<counts.size(); ++i){
+			seen += counts[i];
+			if(seen >= rank){
+				unsigned long long value = highestOf(i);
+				return value < largest? (value > smallest? value: smallest): largest;
+			}
+		}
+		return largest;
+	}
+
+private:
+	static const int SUB_BITS = 6;
+
+	std::vector<unsigned long long> counts;
+	unsigned long long total;
+	double sum;
+	unsigned long long largest, smallest;
+
+	static size_t indexOf(unsigned long long value){
+		if(value < (2ULL << SUB_BITS)){
+			return (size_t)value;
+		}
+#ifdef __GNUC__
+		int msb = 63 - __builtin_clzll(value);
+#else
+		int msb = SUB_BITS + 1;
+		while(msb < 63 && (value >> (msb + 1)) != 0){
+			++msb;
+		}
+#endif
+		int shift = msb - SUB_BITS;
+		return (size_t)(((shift + 1) << SUB_BITS) + (value >> shift) - (1ULL << SUB_BITS));
+	}
+
+	static unsigned long long highestOf(size_t index){
+		if(index < (2U << SUB_BITS)){
+			return index;
+		}
+		int shift = (int)(index >> SUB_BITS) - 1;
+		unsigned long long low = ((index & ((1U << SUB_BITS) - 1)) + (1ULL << SUB_BITS)) << shift;
+		return low + (1ULL << shift) - 1;
+	}
+};
+
+/**
+* when to stop repeating a measurement: once the 95% confidence interval of the mean is
+* narrower than targetWidth (relative to the mean, 0.05 = +-2.5%), or once budgetSeconds
+* were spent on it. at least minRepetitions and at most maxRepetitions runs are made
+*/
+struct StoppingRule{
+	double targetWidth;
+	double budgetSeconds;
+	int minRepetitions;
+	int maxRepetitions;
+
+	StoppingRule(double width = 0.05, double budget = 1.0, int minReps = 5, int maxReps = 10000)
+		: targetWidth(width), budgetSeconds(budget), minRepetitions(minReps), maxRepetitions(maxReps) {}
+};
+
+/**
+* mean and variance updated one value at a time (Welford), for the stopping rule.
+* the interval uses the normal approximation, the report still does the bootstrap
+*/
+class RunningStats{
+public:
+	RunningStats() : count(0), mean(0.0), m2(0.0) {}
+
+	void add(double value){
+		++count;
+		double delta = value - mean;
+		mean += delta / count;
+		m2 += delta * (value - mean);
+	}
+
+	int size() const { return count; }
+
+	double stddev() const { return count > 1? sqrt(m2 / (count - 1)): 0.0; }
+
+	/**
+	* width of the 95% confidence interval of the mean, divided by the mean
+	*/
+	double relativeWidth() const{
+		if(count < 2){
+			return HUGE_VAL;
+		}
+		double width = 2 * 1.96 * stddev() / sqrt((double)count);
+		if(width == 0.0){
+			return 0.0;
+		}
+		return mean != 0.0? width / fabs(mean): HUGE_VAL;
+	}
+
+private:
+	int count;
+	double mean, m2;
+};
+
+/**
+* the growth model that fits a series best.
+* model is one of "1", "log n", "n", "n log n", "n^2", "n^3" and the series is
+* approximated by a + b * model(n); r2 is the coefficient of determination of that fit.
+* the free power law coefficient * n^exponent is fitted separately, in log-log space
+*/
+struct CurveFit{
+	const char *model;
+	double a, b, r2;
+	double coefficient, exponent, powerR2;
+};
+
+/**
+* least squares fit of values against every candidate model, see CurveFit.
+* sizes <= 0 are ignored; models that would need a negative b (a shrinking series
+* for a growing model) are not considered
+*/
+inline CurveFit FitCurve(const std::vector<double> &sizes, const std::vector<double> &values){
+	static const char *names[] = { "1", "log n", "n", "n log n", "n^2", "n^3" };
+	const int MODEL_COUNT = sizeof(names) / sizeof(names[0]);
+	CurveFit best;
+	memset(&best, 0, sizeof(best));
+	best.model = names[0];
+
+	std::vector<double> n, y;
+	size_t i;
+	for(i=0; i<sizes.size() && i<values.size(); ++i){
+		if(sizes[i] > 0){
+			n.push_back(sizes[i]);
+			y.push_back(values[i]);
+		}
+	}
+	size_t count = n.size();
+	if(count == 0){
+		return best;
+	}
+	double mean = 0.0, total = 0.0;
+	for(i=0; i<count; ++i){
+		mean += y[i];
+	}
+	mean /= count;
+	for(i=0; i<count; ++i){
+		total += (y[i] - mean) * (y[i] - mean);
+	}
+	best.a = mean;
+	best.r2 = total == 0.0? 1.0: 0.0;
+
+	for(int m=1; m<MODEL_COUNT && total > 0.0 && count > 1; ++m){
+		std::vector<double> f(count);
+		double fMean = 0.0, covariance = 0.0, variance = 0.0, residual = 0.0;
+		for(i=0; i<count; ++i){
+			switch(m){
+				case 1: f[i] = log(n[i]); break;
+				case 2: f[i] = n[i]; break;
+				case 3: f[i] = n[i] * log(n[i]); break;
+				case 4: f[i] = n[i] * n[i]; break;
+				default: f[i] = n[i] * n[i] * n[i]; break;
+			}
+			fMean += f[i];
+		}
+		fMean /= count;
+		for(i=0; i<count; ++i){
+			covariance += (f[i] - fMean) * (y[i] - mean);
+			variance += (f[i] - fMean) * (f[i] - fMean);
+		}
+		if(variance == 0.0 || covariance < 0.0){
+			continue;
+		}
+		double b = covariance / variance;
+		double a = mean - b * fMean;
+		for(i=0; i<count; ++i){
+			double e = y[i] - (a + b * f[i]);
+			residual += e * e;
+		}
+		double r2 = 1.0 - residual / total;
+		if(r2 > best.r2){
+			best.model = names[m];
+			best.a = a;
+			best.b = b;
+			best.r2 = r2;
+		}
+	}
+
+	//free power law, on the points where the logarithm exists
+	double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0, syy = 0.0;
+	size_t positive = 0;
+	for(i=0; i<count; ++i){
+		if(y[i] <= 0){
+			continue;
+		}
+		double lx = log(n[i]), ly = log(y[i]);
+		sx += lx;
+		sy += ly;
+		sxx += lx * lx;
+		sxy += lx * ly;
+		syy += ly * ly;
+		++positive;
+	}
+	if(positive > 1){
+		double vx = sxx - sx * sx / positive;
+		double vy = syy - sy * sy / positive;
+		double cxy = sxy - sx * sy / positive;
+		if(vx > 0.0){
+			best.exponent = cxy / vx;
+			best.coefficient = exp((sy - best.exponent * sx) / positive);
+			best.powerR2 = vy > 0.0? cxy * cxy / (vx * vy): 1.0;
+		}
+	}
+	return best;
+}
+
+/**
+* reads the first line of fileName, without the newline; "" if it can not be read
+*/
+inline std::string ReadFirstLine(const char *fileName){
+	char line[512] = "";
+	FILE *f = fopen(fileName, "r");
+	if(f == NULL){
+		return "";
+	}
+	if(fgets(line, sizeof(line), f) == NULL){
+		line[0] = '\0';
+	}
+	fclose(f);
+	line[strcspn(line, "\r\n")] = '\0';
+	return line;
+}
+
+/**
+* what the numbers of a run depend on besides the code, written to every report:
+* cpu (model), cores, governor and max_frequency (of cpu 0, in kHz, Linux only), compiler,
+* flags and revision. the flags are the ones the compiler shows through its macros (optimized,
+* NDEBUG, the instruction sets) unless the build passes them all, the revision is the one of
+* the working directory (git describe, with -dirty for local changes) unless the build passes it:
+*
+*	g++ -O2 -DPROFILER_COMPILER_FLAGS="\"-O2 -march=native\"" -DPROFILER_GIT_REVISION="\"$(git describe --always --dirty)\"" ...
+*
+* it is read once, by the first Profiler of the program (see DescribeEnvironment), so that no
+* report starts a shell or reads /proc in the middle of the measurements
+*/
+inline std::map<std::string, std::string> ReadEnvironment(){
+	std::map<std::string, std::string> environment;
+	char text[512];
+#if defined(__linux__)
+	FILE *f = fopen("/proc/cpuinfo", "r");
+	if(f != NULL){
+		while(fgets(text, sizeof(text), f) != NULL){
+			char *colon = strchr(text, ':');
+			//"model name" on x86, some arm kernels only have "Hardware"
+			if(colon && (strncmp(text, "model name", 10) == 0 || strncmp(text, "Hardware", 8) == 0) && colon[1]){
+				text[strcspn(text, "\r\n")] = '\0';
+				environment["cpu"] = colon + 2;
+				break;
+			}
+		}
+		fclose(f);
+	}
+	environment["governor"] = ReadFirstLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+	environment["max_frequency"] = ReadFirstLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_max_freq");
+#elif defined(_MSC_VER)
+	const char *identifier = getenv("PROCESSOR_IDENTIFIER");
+	environment["cpu"] = identifier? identifier: "";
+#endif
+	environment["cores"] = std::to_string(std::thread::hardware_concurrency());
+
+#if defined(__clang__)
+	environment["compiler"] = "clang " __clang_version__;
+#elif defined(__GNUC__)
+	environment["compiler"] = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+	environment["compiler"] = "msvc " + std::to_string(_MSC_FULL_VER);
+#endif
+
+#ifdef PROFILER_COMPILER_FLAGS
+	environment["flags"] = PROFILER_COMPILER_FLAGS;
+#else
+	std::string flags;
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && !defined(_DEBUG))
+	flags += " optimized";
+#endif
+#ifdef __OPTIMIZE_SIZE__
+	flags += " size";
+#endif
+#ifdef NDEBUG
+	flags += " NDEBUG";
+#endif
+#ifdef __FAST_MATH__
+	flags += " fast-math";
+#endif
+#ifdef __SSE4_2__
+	flags += " sse4.2";
+#endif
+#ifdef __AVX2__
+	flags += " avx2";
+#endif
+#ifdef __AVX512F__
+	flags += " avx512f";
+#endif
+#ifdef __ARM_NEON
+	flags += " neon";
+#endif
+	environment["flags"] = flags.empty()? "": flags.substr(1);
+#endif
+
+#ifdef PROFILER_GIT_REVISION
+	environment["revision"] = PROFILER_GIT_REVISION;
+#else
+#ifdef _MSC_VER
+	FILE *git = _popen("git describe --always --dirty 2>NUL", "r");
+#else
+	FILE *git = popen("git describe --always --dirty 2>/dev/null", "r");
+#endif
+	if(git != NULL){
+		if(fgets(text, sizeof(text), git) != NULL){
+			text[strcspn(text, "\r\n")] = '\0';
+			environment["revision"] = text;
+		}
+#ifdef _MSC_VER
+		_pclose(git);
+#else
+		pclose(git);
+#endif
+	}
+#endif
+	//what could not be found out is left out
+	std::map<std::string, std::string>::iterator it = environment.begin();
+	while(it != environment.end()){
+		if(it->second.empty()){
+			environment.erase(it++);
+		}else{
+			++it;
+		}
+	}
+	return environment;
+}
+
+inline const std::map<std::string, std::string> &DescribeEnvironment(){
+	static const std::map<std::string, std::string> environment = ReadEnvironment();
+	return environment;
+}
+
+class Profiler{
+public:
+	/**
+	* maximum lenght for any string that this class should receive
+	*/
+	static const int MAX_NAME_LEN = 128;
+
+	/**
+	* handle of an interned series, see seriesId
+	*/
+	typedef int SeriesId;
+
+	/**
+	* constructs a new profiler with the given title
+	*/
+	Profiler(const char* givenTitle = NULL) : instanceId(nextInstanceId()), origin(Clock::now()), log(NULL){
+		DescribeEnvironment();
+		reset(givenTitle);
+	}
+
+	~Profiler(){
+		for(size_t i=0; i<shards.size(); ++i){
+			delete shards[i];
+		}
+	}
+
+    /**
+    * increases the count for operation name, at the specified size
+    */
+    void reset(const char *newTitle = NULL){
+        flush();
+        if(hasOpcounts() || timeMap.size() != 0 || sampleMap.size() != 0 || hasHistograms()){
+            showReport();
+        }
+        title = newTitle? newTitle: "Title";
+        groups.clear();
+        counterNames.clear();
+        //the ids and size buckets stay valid, only the values are dropped
+        //in the shards the cells are kept, for the counters bound to them
+        clearSeries(seriesList, true);
+        for(size_t i=0; i<shards.size(); ++i){
+            clearSeries(shards[i]->series, false);
+            shards[i]->runningTimers.clear();
+        }
+        timeMap.clear();
+        sampleMap.clear();
+        histograms.clear();
+        for(size_t i=0; i<shards.size(); ++i){
+            shards[i]->histograms.clear();
+            shards[i]->clearSpans();
+        }
+    }
+
+	/**
+	* increases the count for operation name, at the specified size
+	*/
+	void countOperation(const char *name, int size, long long increment=1){
+		countOperation(seriesId(name), size, increment);
+	}
+
+	/**
+	* adds a floating point value to series name, at the specified size.
+	* use this for values that are not whole counts (averages, ratios, 100 * log(n), ...)
+	*/
+	void addValue(const char *name, int size, double value){
+		SeriesId id = seriesId(name);
+		Shard &shard = localShard();
+		int bucket = bucketOf(shard, size);
+		cell(shard.series, id, bucket);
+		shard.series[id].addReal(bucket, value);
+	}
+
+	/**
+	* returns the handle of series name, creating the series if needed.
+	* every thread keeps the names it resolved, so only its first lookup of a name locks,
+	* and remembers the last name of every call site by its address: a call site that
+	* passes the same string every time (a literal) gets its id back after a strcmp,
+	* without building a std::string or searching a map
+	*/
+	SeriesId seriesId(const char *name){
+		Shard &shard = localShard();
+		Shard::NameSlot &slot = shard.nameSlots[Shard::nameSlot(name)];
+		if(slot.name == name && strcmp(slot.key->c_str(), name) == 0){
+			return slot.id;
+		}
+		std::map<std::string, SeriesId>::const_iterator it = shard.ids.find(name);
+		if(it == shard.ids.end()){
+			SeriesId id;
+			{
+				std::lock_guard<std::mutex> lock(tableMutex);
+				id = internSeries(name);
+			}
+			it = shard.ids.insert(std::make_pair(std::string(name), id)).first;
+		}
+		slot.name = name;
+		slot.key = &it->first;
+		slot.id = it->second;
+		return it->second;
+	}
+
+	/**
+	* increases the count for the interned series, at the specified size.
+	* every thread counts into its own shard, without locking; consecutive calls
+	* for the same size skip the size lookup, so this is a single indexed add
+	*/
+	void countOperation(SeriesId id, int size, long long increment=1){
+		Shard &shard = localShard();
+		cell(shard.series, id, bucketOf(shard, size)) += increment;
+		if(shard.currentSpan != 0){
+			shard.spans[shard.currentSpan].operations += increment;
+		}
+	}
+
+	/**
+	* adds one value (the probes of one search, the nanoseconds of one call, ...) to the histogram
+	* of series name at the specified size. the report gets the tail of every histogram as
+	* name_p50, name_p90, name_p99, name_p99_9 and name_max, grouped under name_percentiles
+	*/
+	void recordValue(const char *name, int size, unsigned long long value){
+		recordValue(seriesId(name), size, value);
+	}
+
+	/**
+	* the same, for an interned series: a lookup in the thread's shard and an increment
+	*/
+	void recordValue(SeriesId id, int size, unsigned long long value){
+		Shard &shard = localShard();
+		histogramCell(shard.histograms, id, bucketOf(shard, size)).record(value);
+	}
+
+	/**
+	* the histogram of series name at the specified size, merged over all the threads
+	*/
+	Histogram histogram(const char *name, int size){
+		flush();
+		std::lock_guard<std::mutex> lock(tableMutex);
+		std::map<std::string, SeriesId>::const_iterator id = seriesIds.find(name);
+		std::map<int, int>::const_iterator bucket = sizeBuckets.find(size);
+		if(id == seriesIds.end() || bucket == sizeBuckets.end() ||
+				(size_t)id->second >= histograms.size() || (size_t)bucket->second >= histograms[id->second].size()){
+			return Histogram();
+		}
+		return histograms[id->second][bucket->second];
+	}
+
+	/**
+	* merges the values counted by every thread into the data used by the report.
+	* addSeries, divideValues, showReport and reset call it on their own; all of them
+	* have to be called after the threads that count were joined.
+	* integer counts are summed exactly, and the floating point contributions of the
+	* threads are added in ascending order, so the result does not depend on which
+	* thread finished first
+	*/
+	void flush(){
+		std::lock_guard<std::mutex> lock(tableMutex);
+		std::vector<double> contributions;
+		SeriesId id;
+		size_t bucket, i;
+		if(log != NULL){
+			bool logged = false;
+			for(i=0; i<shards.size(); ++i){
+				logged = logShard(*shards[i]) || logged;
+			}
+			if(logged){
+				log->append(ResultLog::RECORD_FLUSH, "", 0, 0);
+			}
+		}
+		for(id = 0; id < (SeriesId)seriesIds.size(); ++id){
+			for(bucket = 0; bucket < bucketSizes.size(); ++bucket){
+				bool present = false;
+				OPCOUNT_MEASURE sum = 0;
+				contributions.clear();
+				for(i=0; i<shards.size(); ++i){
+					std::vector<Series> &local = shards[i]->series;
+					if((size_t)id >= local.size() || bucket >= local[id].values.size() || !local[id].counted(bucket)){
+						continue;
+					}
+					present = true;
+					sum += local[id].values[bucket];
+					if(local[id].real && bucket < local[id].realValues.size()){
+						contributions.push_back(local[id].realValues[bucket]);
+					}
+				}
+				if(!present){
+					continue;
+				}
+				cell(seriesList, id, (int)bucket) += sum;
+				std::sort(contributions.begin(), contributions.end());
+				for(i=0; i<contributions.size(); ++i){
+					seriesList[id].addReal(bucket, contributions[i]);
+				}
+			}
+		}
+		for(i=0; i<shards.size(); ++i){
+			clearSeries(shards[i]->series, false);
+			mergeSamples(timeMap, shards[i]->timeSamples);
+			mergeSamples(sampleMap, shards[i]->samples);
+			HistogramTable &local = shards[i]->histograms;
+			for(id = 0; id < (SeriesId)local.size(); ++id){
+				for(bucket = 0; bucket < local[id].size(); ++bucket){
+					if(!local[id][bucket].empty()){
+						histogramCell(histograms, id, (int)bucket).merge(local[id][bucket]);
+						local[id][bucket].clear();
+					}
+				}
+			}
+		}
+		//everything of a retired shard is merged now, but its spans, which the span exports read
+		size_t kept = 0;
+		for(i=0; i<shards.size(); ++i){
+			if(shards[i]->retired && shards[i]->spans.size() == 1){
+				delete shards[i];
+			}else{
+				shards[kept++] = shards[i];
+			}
+		}
+		shards.resize(kept);
+	}
+
+	/**
+	* for a thread that is about to end: gives its shard up, so that the next flush merges and frees
+	* it, and a new thread that gets the same id starts from a new shard. the workers of SweepRunner
+	* call it, so that runs do not leave one shard per worker behind. if the thread counts again,
+	* it gets a new shard
+	*/
+	void retireThread(){
+		std::lock_guard<std::mutex> lock(tableMutex);
+		std::map<std::thread::id, Shard*>::iterator it = threadShards.find(std::this_thread::get_id());
+		if(it != threadShards.end()){
+			it->second->retired = true;
+			threadShards.erase(it);
+		}
+		if(shardCache().owner == instanceId){
+			shardCache().owner = 0;
+		}
+	}
+
+	/**
+	* writes everything counted from now on to resultLog, which has to stay open while attached:
+	* the counts, values, time samples and samples every flush merges, and the ones of every
+	* finished cell (see checkpoint). the cells already in the log (from a run that was
+	* interrupted) are loaded first, so the results are the same as if it was never stopped;
+	* what was logged outside of a cell is left out, as the program counts it again.
+	* histograms and spans are not logged
+	*/
+	void attachLog(ResultLog &resultLog){
+		flush();
+		std::lock_guard<std::mutex> lock(tableMutex);
+		const std::vector<ResultLog::Record> &records = resultLog.recovered();
+		size_t first = 0;
+		for(size_t i=0; i<records.size(); ++i){
+			if(records[i].type == ResultLog::RECORD_FLUSH){
+				first = i + 1;
+			}else if(records[i].type == ResultLog::RECORD_CELL){
+				for(; first < i; ++first){
+					replay(records[first]);
+				}
+				first = i + 1;
+			}
+		}
+		log = &resultLog;
+	}
+
+	/**
+	* marks the cell (size, repetition) of sweep as finished: what the calling thread counted
+	* since its last checkpoint is written to the log with the mark, and merged. without a log
+	* it does nothing
+	*/
+	void checkpoint(const char *sweep, int size, int repetition){
+		if(log == NULL){
+			return;
+		}
+		Shard &shard = localShard();
+		std::lock_guard<std::mutex> lock(tableMutex);
+		logShard(shard);
+		log->append(ResultLog::RECORD_CELL, sweep, size, (unsigned long long)repetition);
+		log->sync();
+		mergeShard(shard);
+	}
+
+	/**
+	* true if the attached log has the cell (size, repetition) of sweep as finished
+	*/
+	bool finished(const char *sweep, int size, int repetition){
+		std::lock_guard<std::mutex> lock(tableMutex);
+		return log != NULL && log->finished(sweep, size, repetition);
+	}
+
+	/**
+	* records one sample (e.g. the op count of one repetition) for series name, at the specified size.
+	* every sample is kept, and the report gets name_mean, name_median, name_stddev, name_p5, name_p95
+	* and the bootstrap confidence interval of the mean (name_ci_low, name_ci_high).
+	* use it instead of countOperation + divideValues when the spread of the repetitions matters
+	*/
+	void addSample(const char *name, int size, double value){
+		localShard().samples[name][size].push_back(value);
+	}
+
+	/**
+	* fits series name (an operation count series, or the median of a timed series)
+	* against the growth models, see CurveFit. the report contains the fit of every series
+	*/
+	CurveFit fitCurve(const char *name){
+		flush();
+		OpcountMap counts;
+		RealMap reals;
+		collectOpcounts(counts, reals);
+		collectTimeMedians(reals);
+		std::vector<double> sizes, values;
+		if(counts.count(name)){
+			sequenceValues(counts[name], sizes, values);
+		}else if(reals.count(name)){
+			sequenceValues(reals[name], sizes, values);
+		}
+		return FitCurve(sizes, values);
+	}
+
+	/**
+	* statistics of the samples recorded for series name (with addSample or with the timers)
+	* at the specified size; count is 0 if there are none
+	*/
+	SampleSummary summary(const char *name, int size){
+		flush();
+		std::vector<double> values;
+		if(sampleMap.count(name) && sampleMap[name].count(size)){
+			values = sampleMap[name][size];
+		}else if(timeMap.count(name) && timeMap[name].count(size)){
+			values.assign(timeMap[name][size].begin(), timeMap[name][size].end());
+		}
+		return SummarizeSamples(values);
+	}
+
+	/**
+	* starts the wall-clock timer for series name, at the specified size.
+	* timers are kept per thread, so several threads can time the same series and size
+	*/
+	void startTimer(const char *name, int size){
+		localShard().runningTimers[TimerKey(name, size)] = Clock::now();
+	}
+
+	/**
+	* stops the timer started with startTimer and records the elapsed nanoseconds as one sample
+	*/
+	void stopTimer(const char *name, int size){
+		Clock::time_point stopTime = Clock::now();
+		Shard &shard = localShard();
+		TimerMap::iterator it = shard.runningTimers.find(TimerKey(name, size));
+		if(it == shard.runningTimers.end()){
+			return;
+		}
+		shard.timeSamples[name][size].push_back(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(stopTime - it->second).count());
+		shard.runningTimers.erase(it);
+	}
+
+	/**
+	* times func at the specified size: runs it warmup times without recording,
+	* then repetitions times recording one sample each.
+	* setup is called (untimed) before every run, so that each run gets a fresh input
+	*/
+	template <typename Setup, typename Func>
+	void measureTime(const char *name, int size, Setup setup, Func func, int repetitions=5, int warmup=1){
+		int i;
+		for(i=0; i<warmup; ++i){
+			setup();
+			func();
+		}
+		for(i=0; i<repetitions; ++i){
+			setup();
+			startTimer(name, size);
+			func();
+			stopTimer(name, size);
+		}
+	}
+
+	/**
+	* like measureTime, but instead of a fixed count it repeats func until the samples
+	* satisfy rule (see StoppingRule). the number of timed runs is returned and added
+	* to the series name_iterations, so the report shows what each size cost
+	*/
+	template <typename Setup, typename Func>
+	int measureTimeAdaptive(const char *name, int size, Setup setup, Func func,
+			const StoppingRule &rule = StoppingRule(), int warmup=1){
+		for(int i=0; i<warmup; ++i){
+			setup();
+			func();
+		}
+		std::vector<TIME_MEASURE> *samples = &localShard().timeSamples[name][size];
+		int repetitions = repeatUntilStable(name, size, rule, [&]() -> double {
+			setup();
+			Clock::time_point startTime = Clock::now();
+			func();
+			Clock::time_point stopTime = Clock::now();
+			TIME_MEASURE elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(stopTime - startTime).count();
+			samples->push_back(elapsed);
+			return (double)elapsed;
+		});
+		return repetitions;
+	}
+
+	/**
+	* the sampled counterpart: calls sample until the values it returns satisfy rule,
+	* recording each of them with addSample. returns the number of samples, also
+	* added to name_iterations
+	*/
+	template <typename Sample>
+	int addSamplesAdaptive(const char *name, int size, Sample sample, const StoppingRule &rule = StoppingRule()){
+		std::vector<double> *samples = &localShard().samples[name][size];
+		return repeatUntilStable(name, size, rule, [&]() -> double {
+			double value = sample();
+			samples->push_back(value);
+			return value;
+		});
+	}
+
+	/**
+	* starts the hardware counters for series name, at the specified size.
+	* returns false (and records nothing) if the counters are not available
+	*/
+	bool startCounters(const char *name, int size){
+		Shard &shard = localShard();
+		if(!shard.perf.available()){
+			return false;
+		}
+		shard.countersKey = TimerKey(name, size);
+		shard.perf.start();
+		return true;
+	}
+
+	/**
+	* stops the hardware counters and adds their values to the series
+	* name_cycles, name_instructions, name_L1_misses, name_LLC_misses, name_branch_misses
+	* and name_dTLB_misses. the miss counters are grouped under name_misses; the report
+	* adds name_IPC, the instructions over the cycles of every size
+	*/
+	void stopCounters(const char *name, int size){
+		Shard &shard = localShard();
+		PerfCounters &perf = shard.perf;
+		if(!perf.available() || shard.countersKey != TimerKey(name, size)){
+			return;
+		}
+		perf.stop();
+		shard.countersKey = TimerKey();
+		std::vector<std::string> misses;
+		for(int i=0; i<PerfCounters::COUNTER_COUNT; ++i){
+			std::string series = std::string(name) + "_" + PerfCounters::counterName(i);
+			if(perf.has(i)){
+				countOperation(series.c_str(), size, (long long)perf.get(i));
+				if(i >= PerfCounters::L1_MISSES){
+					misses.push_back(series);
+				}
+			}
+		}
+		std::lock_guard<std::mutex> lock(tableMutex);
+		counterNames.insert(name);
+		if(!misses.empty()){
+			groups[std::string(name) + "_misses"] = misses;
+		}
+	}
+
+	/**
+	* divides every series of stopCounters(name, ...) by divisor, as divideValues does;
+	* name_IPC is a ratio, it stays the same
+	*/
+	void divideCounters(const char *name, unsigned int divisor){
+		for(int i=0; i<PerfCounters::COUNTER_COUNT; ++i){
+			divideValues((std::string(name) + "_" + PerfCounters::counterName(i)).c_str(), divisor);
+		}
+	}
+
+	/**
+	* creates a new group from the given members
+	* the members will be displayed in the same chart
+	*/
+	void createGroup(const char *groupName, const char *member1, const char *member2 = NULL,
+						const char *member3 = NULL, const char *member4 = NULL,
+						const char *member5 = NULL, const char *member6 = NULL,
+						const char *member7 = NULL, const char *member8 = NULL,
+						const char *member9 = NULL, const char *member10 = NULL){
+		groups[groupName] = std::vector<std::string>();
+		//this is a bad coding style
+		//kids, don't do this at home
+#define ADD_MEMBER(member) if(member) {groups[groupName].push_back(member);}
+		ADD_MEMBER(member1);
+		ADD_MEMBER(member2);
+		ADD_MEMBER(member3);
+		ADD_MEMBER(member4);
+		ADD_MEMBER(member5);
+		ADD_MEMBER(member6);
+		ADD_MEMBER(member7);
+		ADD_MEMBER(member8);
+		ADD_MEMBER(member9);
+		ADD_MEMBER(member10);
+#undef ADD_MEMBER
+	}
+
+	/**
+	* the same, for any number of members
+	*/
+	void createGroup(const char *groupName, const std::vector<std::string> &members){
+		groups[groupName] = members;
+	}
+
+	/**
+	* adds key to the environment of the reports (see DescribeEnvironment), or replaces
+	* one of its entries; e.g. how the harness ran the measurements. kept by reset
+	*/
+	void setEnvironment(const char *key, const char *value){
+		environmentNotes[key] = value;
+	}
+
+	/**
+	* creates a new series, by summing the given ones
+	*/
+	void addSeries(const char *newName, const char *series1, const char *series2){
+		flush();
+		if (hasData(series1) && hasData(series2)){
+				SeriesId id1 = seriesId(series1), id2 = seriesId(series2), newId = seriesId(newName);
+				if((size_t)newId >= seriesList.size()){
+					seriesList.resize(newId + 1);
+				}
+				Series &result = seriesList[newId];
+				std::fill(result.values.begin(), result.values.end(), 0);
+				std::fill(result.present.begin(), result.present.end(), 0);
+				result.realValues.clear();
+				result.real = seriesList[id1].real || seriesList[id2].real;
+				for (size_t bucket = 0; bucket < seriesList[id1].values.size(); ++bucket){
+					if(!seriesList[id1].present[bucket]){
+						continue;
+					}
+					cell(seriesList, newId, (int)bucket) = seriesList[id1].values[bucket];
+					Series &sum = seriesList[newId];
+					if(sum.real){
+						sum.realValues.resize(sum.values.size(), 0.0);
+						sum.realValues[bucket] = seriesList[id1].realAt(bucket);
+					}
+					if(bucket < seriesList[id2].values.size() && seriesList[id2].present[bucket]){
+						sum.values[bucket] += seriesList[id2].values[bucket];
+						if(sum.real){
+							sum.realValues[bucket] += seriesList[id2].realAt(bucket);
+						}
+					}
+				}
+		}
+	}
+
+    /**
+    * divides the values in a series.
+    * the result is kept as a floating point series, so averages are not truncated
+    */
+	void divideValues(const char *series, unsigned int divisor) {
+		flush();
+		if (hasData(series) && divisor != 0) {
+			Series &target = seriesList[seriesId(series)];
+			target.realValues.resize(target.values.size(), 0.0);
+			for (size_t bucket = 0; bucket < target.values.size(); ++bucket) {
+				target.realValues[bucket] = (target.realValues[bucket] + (double)target.values[bucket]) / divisor;
+				target.values[bucket] = 0;
+			}
+			target.real = true;
+		}
+	}
+
+	/**
+	* creates and shows the report
+	*/
+	int showReport(){
+		FILE *fout = NULL;
+		char reportName[200];
+		time_t crtTime = time(0);
+		struct tm now;
+#ifdef _MSC_VER
+		localtime_s(&now, &crtTime);
+#else
+        now = *localtime(&crtTime);
+#endif
+
+#ifdef _MSC_VER
+		_snprintf_s(
+#else
+        snprintf(
+#endif
+                            reportName, sizeof(reportName), 
+                            "report-%s-%04d%02d%02d-%02d%02d%02d.html", 
+							title.c_str(),
+							now.tm_year + 1900,
+							now.tm_mon + 1,
+							now.tm_mday,
+							now.tm_hour,
+							now.tm_min,
+							now.tm_sec
+		);
+#ifdef _MSC_VER
+		fopen_s(&fout, reportName, "wb");
+#else
+		fout = fopen(reportName, "wb");
+#endif
+		if(fout == NULL){
+			return -1;
+		}
+		Report report;
+		collectReport(report);
+		fwrite(HtmlGen::htmlFirst, 1, sizeof(HtmlGen::htmlFirst)/sizeof(HtmlGen::htmlFirst[0]), fout);
+		writeJson(fout, report);
+		fwrite(HtmlGen::htmlLast, 1, sizeof(HtmlGen::htmlLast)/sizeof(HtmlGen::htmlLast[0]), fout);
+		fclose(fout);
+
+#ifdef _MSC_VER
+		ShellExecuteA(NULL, "open", reportName, NULL, NULL, SW_SHOW);
+#endif
+		return 0;
+	}
+
+	enum ExportFormat { EXPORT_JSON, EXPORT_CSV, EXPORT_BINARY };
+
+	/**
+	* writes the results, without the html around them, to an open stream.
+	* the output is written front to back and never seeks, so fout can be a pipe or a socket:
+	*
+	*	EXPORT_JSON   - the same object the html report embeds (opcount, times, groups, fits)
+	*	EXPORT_CSV    - one "section,series,size,value" line per point, section is opcount or times
+	*	EXPORT_BINARY - columnar, little endian: "PRFB", u32 version (1), u32 series count, then
+	*	                for every series: u8 section (0 opcount, 1 times), u8 value type (0 u64,
+	*	                1 f64, 2 i64), u16 name length, the name, u32 point count, the sizes as
+	*	                i32 and the values as 8 bytes each
+	*
+	* series names are written as in the report (anything but letters, digits and '_'
+	* becomes '_'). returns 0, or -1 if the stream reported an error
+	*/
+	int exportResults(FILE *fout, ExportFormat format){
+		Report report;
+		collectReport(report);
+		switch(format){
+			case EXPORT_CSV: writeCsv(fout, report); break;
+			case EXPORT_BINARY: writeBinary(fout, report); break;
+			default: writeJson(fout, report); break;
+		}
+		if(fflush(fout) != 0 || ferror(fout)){
+			return -1;
+		}
+		return 0;
+	}
+
+	/**
+	* same as above, for a file descriptor (stdout is 1); fd stays open
+	*/
+	int exportResults(int fd, ExportFormat format){
+		FILE *fout = openDescriptor(fd);
+		if(fout == NULL){
+			return -1;
+		}
+		int result = exportResults(fout, format);
+		if(fclose(fout) != 0){
+			result = -1;
+		}
+		return result;
+	}
+
+	/**
+	* opens a span named name below the innermost open span of the calling thread.
+	* the spans of a thread form a call tree: every path (main;quicksort;quicksort;...)
+	* is one node, with the number of calls, the time spent inside and the operations
+	* counted (countOperation, SpanCounter) while it was the innermost span.
+	* use Span rather than calling enterSpan and exitSpan by hand
+	*/
+	void enterSpan(const char *name){
+		Shard &shard = localShard();
+		int parent = shard.currentSpan;
+		int child = 0;
+		std::vector<int> &children = shard.spans[parent].children;
+		for(size_t i=0; i<children.size(); ++i){
+			if(shard.spans[children[i]].name == name){
+				child = children[i];
+				break;
+			}
+		}
+		if(child == 0){
+			child = (int)shard.spans.size();
+			shard.spans.push_back(SpanNode(name, parent));
+			shard.spans[parent].children.push_back(child);
+		}
+		SpanNode &node = shard.spans[child];
+		node.calls++;
+		shard.currentSpan = child;
+		node.start = Clock::now();
+	}
+
+	/**
+	* closes the innermost open span of the calling thread
+	*/
+	void exitSpan(){
+		Clock::time_point now = Clock::now();
+		Shard &shard = localShard();
+		if(shard.currentSpan == 0){
+			return;
+		}
+		SpanNode &node = shard.spans[shard.currentSpan];
+		TIME_MEASURE elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - node.start).count();
+		node.time += elapsed;
+		if(shard.spanEvents.size() < MAX_SPAN_EVENTS){
+			SpanEvent event;
+			event.node = shard.currentSpan;
+			event.start = std::chrono::duration_cast<std::chrono::nanoseconds>(node.start - origin).count();
+			event.duration = elapsed;
+			shard.spanEvents.push_back(event);
+		}
+		shard.currentSpan = node.parent;
+	}
+
+	/**
+	* adds increment operations to the innermost open span of the calling thread
+	*/
+	void countSpan(long long increment = 1){
+		Shard &shard = localShard();
+		shard.spans[shard.currentSpan].operations += increment;
+	}
+
+	/**
+	* a span that lasts as long as the object:
+	*
+	*	void quicksort(int a[], int l, int r){
+	*		Profiler::Span span(p, "quicksort");
+	*		...
+	*	}
+	*/
+	class Span{
+	public:
+		Span(Profiler &prof, const char *name) : profiler(prof) { profiler.enterSpan(name); }
+		~Span() { profiler.exitSpan(); }
+	private:
+		Profiler &profiler;
+		Span(const Span&);
+		Span &operator=(const Span&);
+	};
+
+	/**
+	* every thread keeps the first MAX_SPAN_EVENTS spans it closes for SPANS_CHROME_TRACE;
+	* the call tree itself has no limit
+	*/
+	static const size_t MAX_SPAN_EVENTS = 1 << 20;
+
+	enum SpanFormat { SPANS_TREE, SPANS_FOLDED, SPANS_FOLDED_OPS, SPANS_CHROME_TRACE };
+
+	/**
+	* writes the spans of all the threads, after they were joined:
+	*
+	*	SPANS_TREE         - the call tree merged over the threads, one node per line with its calls,
+	*	                     total and self time (ms), total and self operations, indented by depth
+	*	SPANS_FOLDED       - one "main;quicksort;quicksort self_ns" line per node, the folded stacks
+	*	                     read by flamegraph.pl, speedscope and the like
+	*	SPANS_FOLDED_OPS   - the same with the self operations, which do not depend on the machine
+	*	SPANS_CHROME_TRACE - every span as a complete event of the Chrome trace event format
+	*	                     (chrome://tracing, Perfetto), one tid per thread
+	*
+	* returns 0, or -1 if the stream reported an error
+	*/
+	int exportSpans(FILE *fout, SpanFormat format){
+		std::lock_guard<std::mutex> lock(tableMutex);
+		if(format == SPANS_CHROME_TRACE){
+			writeTrace(fout);
+		}else{
+			std::vector<SpanNode> tree(1, SpanNode("", 0));
+			for(size_t i=0; i<shards.size(); ++i){
+				mergeSpans(tree, 0, shards[i]->spans, 0);
+			}
+			std::string path;
+			if(format == SPANS_TREE){
+				fprintf(fout, "calls\ttotal_ms\tself_ms\ttotal_ops\tself_ops\tspan\n");
+			}
+			writeSpans(fout, format, tree, 0, -1, path);
+		}
+		if(fflush(fout) != 0 || ferror(fout)){
+			return -1;
+		}
+		return 0;
+	}
+
+	/**
+	* same as above, for a file descriptor; fd stays open
+	*/
+	int exportSpans(int fd, SpanFormat format){
+		FILE *fout = openDescriptor(fd);
+		if(fout == NULL){
+			return -1;
+		}
+		int result = exportSpans(fout, format);
+		if(fclose(fout) != 0){
+			result = -1;
+		}
+		return result;
+	}
+
+private:
+	typedef unsigned long long OPCOUNT_MEASURE;
+
+	typedef std::map<int, OPCOUNT_MEASURE> OpcountSequence;
+	typedef std::map<std::string, OpcountSequence> OpcountMap;
+	typedef std::map<int, double> RealSequence;
+	typedef std::map<std::string, RealSequence> RealMap;
+
+	typedef std::map<std::string, std::vector<std::string> > GroupMap;
+
+	typedef long long TIME_MEASURE;
+	typedef std::chrono::steady_clock Clock;
+
+	typedef std::map<int, TIME_MEASURE> TimeSequence;
+	typedef std::map<std::string, TimeSequence> TimeMap;
+	typedef std::map<int, std::vector<TIME_MEASURE> > TimeSamples;
+	typedef std::map<std::string, TimeSamples> TimeSampleMap;
+	typedef std::map<int, std::vector<double> > ValueSamples;
+	typedef std::map<std::string, ValueSamples> ValueSampleMap;
+	/**
+	* everything a report shows, summarized from the merged series
+	*/
+	struct Report{
+		OpcountMap opcounts;
+		RealMap reals;
+		TimeMap times;
+		RealMap timeStatistics;
+		RealMap timeMedians;
+		GroupMap groups;
+		std::map<std::string, std::string> environment;
+	};
+
+	typedef std::pair<std::string, int> TimerKey;
+	typedef std::map<TimerKey, Clock::time_point> TimerMap;
+
+	/**
+	* the values of a series, stored contiguously and indexed by size bucket
+	*/
+	struct Series{
+		std::vector<OPCOUNT_MEASURE> values;
+		//0 for no value, 1 for a value; in a shard, 2 for a cell kept by flush, checkpoint or
+		//reset (for the counters bound to it), that only has a value again if it is not 0
+		std::vector<char> present;
+		//floating point part of the series, only used once real is set (addValue, divideValues)
+		std::vector<double> realValues;
+		bool real;
+
+		Series() : real(false) {}
+
+		void addReal(size_t bucket, double value){
+			if(realValues.size() <= bucket){
+				realValues.resize(values.size(), 0.0);
+			}
+			realValues[bucket] += value;
+			real = true;
+		}
+
+		/**
+		* true if the cell has a value to merge: a kept cell only once it counted again
+		*/
+		bool counted(size_t bucket) const{
+			return present[bucket] == 1 || (present[bucket] == 2 && values[bucket] != 0);
+		}
+
+		double realAt(size_t bucket) const{
+			double value = (double)values[bucket];
+			if(bucket < realValues.size()){
+				value += realValues[bucket];
+			}
+			return value;
+		}
+	};
+
+	/**
+	* a node of the call tree of a thread (node 0 is the root), see enterSpan.
+	* time and operations are the totals of the node; the self values are what
+	* is left after taking out the children
+	*/
+	struct SpanNode{
+		std::string name;
+		int parent;
+		std::vector<int> children;
+		long long calls;
+		TIME_MEASURE time;
+		long long operations;
+		Clock::time_point start;
+
+		SpanNode(const char *spanName, int parentNode) : name(spanName), parent(parentNode), calls(0), time(0), operations(0) {}
+	};
+
+	struct SpanEvent{
+		int node;
+		TIME_MEASURE start, duration;
+	};
+
+	/**
+	* the values counted by one thread, merged into the profiler by flush
+	*/
+	typedef std::vector<std::vector<Histogram> > HistogramTable;
+
+	struct Shard{
+		std::vector<Series> series;
+		HistogramTable histograms;
+		int lastSize, lastBucket;
+		TimerMap runningTimers;
+		TimeSampleMap timeSamples;
+		ValueSampleMap samples;
+		PerfCounters perf;
+		TimerKey countersKey;
+		//the ids and buckets this thread has looked up, which never change
+		std::map<std::string, SeriesId> ids;
+		std::map<int, int> buckets;
+		//the last name seen at every slot, by its address, with its key in ids (see seriesId)
+		struct NameSlot{
+			const char *name;
+			const std::string *key;
+			SeriesId id;
+		};
+		static const int NAME_SLOTS = 64;
+		NameSlot nameSlots[NAME_SLOTS];
+		std::vector<SpanNode> spans;
+		int currentSpan;
+		std::vector<SpanEvent> spanEvents;
+		//its thread ended (see retireThread)
+		bool retired;
+
+		Shard() : lastSize(0), lastBucket(-1), currentSpan(0), retired(false) {
+			memset(nameSlots, 0, sizeof(nameSlots));
+			clearSpans();
+		}
+
+		static int nameSlot(const char *name){
+			return (int)(((unsigned long long)(size_t)name * 0x9E3779B97F4A7C15ULL) >> 58);
+		}
+
+		void clearSpans(){
+			spans.assign(1, SpanNode("", 0));
+			currentSpan = 0;
+			spanEvents.clear();
+		}
+	};
+
+public:
+	/**
+	* a counter bound to one series and size, in the shard of the thread that created it.
+	* use it only from that thread
+	*/
+	class OperationCounter{
+		SeriesId id;
+		int bucket;
+		Profiler &profiler;
+		Shard *shard;
+		friend class Profiler;
+		OperationCounter(Profiler &prof, SeriesId seriesId, int size) : profiler(prof) {
+			id = seriesId;
+			shard = &profiler.localShard();
+			bucket = profiler.bucketOf(*shard, size);
+			cell(shard->series, id, bucket); // force creation
+		}
+	  public:
+		void count(long long increment=1) { shard->series[id].values[bucket] += increment; }
+		OPCOUNT_MEASURE get() const {
+			OPCOUNT_MEASURE value = shard->series[id].values[bucket];
+			std::lock_guard<std::mutex> lock(profiler.tableMutex);
+			if((size_t)id < profiler.seriesList.size() && (size_t)bucket < profiler.seriesList[id].values.size()){
+				value += profiler.seriesList[id].values[bucket];
+			}
+			return value;
+		}
+	};
+	
+	OperationCounter createOperation(const char *name, int size) {
+		return OperationCounter(*this, seriesId(name), size);
+	}
+
+	OperationCounter createOperation(SeriesId id, int size) {
+		return OperationCounter(*this, id, size);
+	}
+
+	/**
+	* counts into one series from the thread that created it, for inner loops: the series
+	* and the shard are resolved once, the bucket when the size changes, so a count is a
+	* comparison and an add:
+	*
+	*	Profiler::SeriesCounter comparisons = p.seriesCounter("comparisons");
+	*	for(...){ ... comparisons.count(n); }
+	*
+	* the spans do not see these counts (see countSpan). use it only from that thread
+	*/
+	class SeriesCounter{
+		Profiler *profiler;
+		Shard *shard;
+		SeriesId id;
+		int size, bucket;
+		friend class Profiler;
+		SeriesCounter(Profiler &prof, SeriesId seriesId) : profiler(&prof), id(seriesId),
+				size(std::numeric_limits<int>::min()), bucket(0) {
+			shard = &profiler->localShard();
+		}
+		void bind(int newSize){
+			bucket = profiler->bucketOf(*shard, newSize);
+			cell(shard->series, id, bucket);
+			size = newSize;
+		}
+	  public:
+		void count(int countSize, long long increment=1) {
+			if(countSize != size){
+				bind(countSize);
+			}
+			shard->series[id].values[bucket] += increment;
+		}
+	};
+
+	SeriesCounter seriesCounter(const char *name) {
+		return SeriesCounter(*this, seriesId(name));
+	}
+
+	SeriesCounter seriesCounter(SeriesId id) {
+		return SeriesCounter(*this, id);
+	}
+
+private:
+	std::string title;
+	GroupMap groups;
+	//the names given to stopCounters, to derive their IPC
+	std::set<std::string> counterNames;
+	//merged values, filled by flush
+	std::vector<Series> seriesList;
+	HistogramTable histograms;
+	TimeSampleMap timeMap;
+	ValueSampleMap sampleMap;
+	//the tables below are shared by all the threads and guarded by tableMutex
+	std::map<std::string, SeriesId> seriesIds;
+	std::vector<std::string> seriesNames;
+	std::vector<int> bucketSizes;
+	std::map<int, int> sizeBuckets;
+	std::vector<Shard*> shards;
+	std::map<std::thread::id, Shard*> threadShards;
+	std::mutex tableMutex;
+	unsigned long long instanceId;
+	Clock::time_point origin;
+	ResultLog *log;
+	std::map<std::string, std::string> environmentNotes;
+
+	Profiler(const Profiler&);
+	Profiler &operator=(const Profiler&);
+
+	static unsigned long long nextInstanceId(){
+		static std::atomic<unsigned long long> next(1);
+		return next++;
+	}
+
+	struct ShardCache{
+		unsigned long long owner;
+		Shard *shard;
+	};
+
+	/**
+	* the last shard used by the calling thread
+	*/
+	static ShardCache &shardCache(){
+		static thread_local ShardCache cache = {0, NULL};
+		return cache;
+	}
+
+	/**
+	* the shard of the calling thread, created on the first call.
+	* the last shard used by the thread is cached, so only the first call takes the lock
+	*/
+	Shard &localShard(){
+		ShardCache &cache = shardCache();
+		if(cache.owner == instanceId){
+			return *cache.shard;
+		}
+		std::lock_guard<std::mutex> lock(tableMutex);
+		Shard *&shard = threadShards[std::this_thread::get_id()];
+		if(shard == NULL){
+			shard = new Shard();
+			shards.push_back(shard);
+		}
+		cache.owner = instanceId;
+		cache.shard = shard;
+		return *shard;
+	}
+
+	/**
+	* returns the bucket that holds the values for size, allocating one for a new size
+	*/
+	int bucketOf(Shard &shard, int size){
+		if(size == shard.lastSize && shard.lastBucket != -1){
+			return shard.lastBucket;
+		}
+		std::map<int, int>::const_iterator it = shard.buckets.find(size);
+		if(it != shard.buckets.end()){
+			shard.lastBucket = it->second;
+		}else{
+			std::lock_guard<std::mutex> lock(tableMutex);
+			shard.lastBucket = sizeBucket(size);
+			shard.buckets[size] = shard.lastBucket;
+		}
+		shard.lastSize = size;
+		return shard.lastBucket;
+	}
+
+	/**
+	* the lookups of seriesId and bucketOf, for callers that hold tableMutex
+	*/
+	SeriesId internSeries(const std::string &name){
+		std::map<std::string, SeriesId>::const_iterator it = seriesIds.find(name);
+		if(it != seriesIds.end()){
+			return it->second;
+		}
+		SeriesId id = (SeriesId)seriesIds.size();
+		seriesIds[name] = id;
+		seriesNames.push_back(name);
+		return id;
+	}
+
+	int sizeBucket(int size){
+		std::map<int, int>::const_iterator it = sizeBuckets.find(size);
+		if(it != sizeBuckets.end()){
+			return it->second;
+		}
+		int bucket = (int)bucketSizes.size();
+		bucketSizes.push_back(size);
+		sizeBuckets[size] = bucket;
+		return bucket;
+	}
+
+	/**
+	* appends what shard counted since it was last merged to the log; returns false if there was nothing
+	*/
+	bool logShard(const Shard &shard){
+		bool logged = false;
+		for(SeriesId id = 0; id < (SeriesId)shard.series.size(); ++id){
+			const Series &series = shard.series[id];
+			for(size_t bucket = 0; bucket < series.values.size(); ++bucket){
+				//a kept cell was logged by an earlier flush, unless it counted since
+				if(!series.counted(bucket)){
+					continue;
+				}
+				log->append(ResultLog::RECORD_COUNT, seriesNames[id], bucketSizes[bucket], series.values[bucket]);
+				if(series.real && bucket < series.realValues.size()){
+					log->append(ResultLog::RECORD_REAL, seriesNames[id], bucketSizes[bucket], valueBits(series.realValues[bucket]));
+				}
+				logged = true;
+			}
+		}
+		logged = logSamples(ResultLog::RECORD_TIME, shard.timeSamples) || logged;
+		logged = logSamples(ResultLog::RECORD_SAMPLE, shard.samples) || logged;
+		return logged;
+	}
+
+	template <typename SampleMap>
+	bool logSamples(int type, const SampleMap &samples){
+		bool logged = false;
+		typename SampleMap::const_iterator it1;
+		typename SampleMap::mapped_type::const_iterator it2;
+		for(it1 = samples.begin(); it1 != samples.end(); ++it1){
+			for(it2 = it1->second.begin(); it2 != it1->second.end(); ++it2){
+				for(size_t i=0; i<it2->second.size(); ++i){
+					log->append(type, it1->first, it2->first, valueBits(it2->second[i]));
+					logged = true;
+				}
+			}
+		}
+		return logged;
+	}
+
+	/**
+	* adds a record of a resumed log to the merged values
+	*/
+	void replay(const ResultLog::Record &record){
+		double real;
+		SeriesId id;
+		int bucket;
+		switch(record.type){
+			case ResultLog::RECORD_COUNT:
+				cell(seriesList, internSeries(record.name), sizeBucket(record.size)) += record.value;
+				break;
+			case ResultLog::RECORD_REAL:
+				memcpy(&real, &record.value, sizeof(real));
+				id = internSeries(record.name);
+				bucket = sizeBucket(record.size);
+				cell(seriesList, id, bucket);
+				seriesList[id].addReal(bucket, real);
+				break;
+			case ResultLog::RECORD_TIME:
+				timeMap[record.name][record.size].push_back((TIME_MEASURE)record.value);
+				break;
+			case ResultLog::RECORD_SAMPLE:
+				memcpy(&real, &record.value, sizeof(real));
+				sampleMap[record.name][record.size].push_back(real);
+				break;
+		}
+	}
+
+	/**
+	* merges the values of one shard, in the order they come (see checkpoint), and empties it
+	*/
+	void mergeShard(Shard &shard){
+		for(SeriesId id = 0; id < (SeriesId)shard.series.size(); ++id){
+			Series &series = shard.series[id];
+			for(size_t bucket = 0; bucket < series.values.size(); ++bucket){
+				if(!series.counted(bucket)){
+					continue;
+				}
+				cell(seriesList, id, (int)bucket) += series.values[bucket];
+				if(series.real && bucket < series.realValues.size()){
+					seriesList[id].addReal(bucket, series.realValues[bucket]);
+				}
+			}
+		}
+		clearSeries(shard.series, false);
+		mergeSamples(timeMap, shard.timeSamples);
+		mergeSamples(sampleMap, shard.samples);
+		for(SeriesId id = 0; id < (SeriesId)shard.histograms.size(); ++id){
+			for(size_t bucket = 0; bucket < shard.histograms[id].size(); ++bucket){
+				if(!shard.histograms[id][bucket].empty()){
+					histogramCell(histograms, id, (int)bucket).merge(shard.histograms[id][bucket]);
+					shard.histograms[id][bucket].clear();
+				}
+			}
+		}
+	}
+
+	static Histogram &histogramCell(HistogramTable &table, SeriesId id, int bucket){
+		if((size_t)id >= table.size()){
+			table.resize(id + 1);
+		}
+		if((size_t)bucket >= table[id].size()){
+			table[id].resize(bucket + 1);
+		}
+		return table[id][bucket];
+	}
+
+	bool hasHistograms() const{
+		for(size_t id=0; id<histograms.size(); ++id){
+			for(size_t bucket=0; bucket<histograms[id].size(); ++bucket){
+				if(!histograms[id][bucket].empty()){
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	/**
+	* adds the percentiles of every histogram to summary, see recordValue
+	*/
+	void summarizeHistograms(RealMap &summary, GroupMap &reportGroups){
+		static const double PERCENTILES[] = { 50, 90, 99, 99.9 };
+		static const char *SUFFIXES[] = { "_p50", "_p90", "_p99", "_p99_9" };
+		std::map<std::string, SeriesId>::const_iterator it;
+		for(it = seriesIds.begin(); it != seriesIds.end(); ++it){
+			if((size_t)it->second >= histograms.size()){
+				continue;
+			}
+			const std::vector<Histogram> &buckets = histograms[it->second];
+			std::vector<std::string> members;
+			for(int p=0; p<4; ++p){
+				members.push_back(it->first + SUFFIXES[p]);
+			}
+			members.push_back(it->first + "_max");
+			bool recorded = false;
+			for(size_t bucket=0; bucket<buckets.size(); ++bucket){
+				if(buckets[bucket].empty()){
+					continue;
+				}
+				recorded = true;
+				int size = bucketSizes[bucket];
+				for(int p=0; p<4; ++p){
+					summary[members[p]][size] = (double)buckets[bucket].percentile(PERCENTILES[p]);
+				}
+				summary[members[4]][size] = (double)buckets[bucket].max();
+			}
+			if(recorded){
+				reportGroups[it->first + "_percentiles"] = members;
+			}
+		}
+	}
+
+	/**
+	* the value of series id at the given bucket, marked as present
+	*/
+	static OPCOUNT_MEASURE &cell(std::vector<Series> &seriesList, SeriesId id, int bucket){
+		if((size_t)id >= seriesList.size()){
+			seriesList.resize(id + 1);
+		}
+		Series &series = seriesList[id];
+		if((size_t)bucket >= series.values.size()){
+			series.values.resize(bucket + 1, 0);
+			series.present.resize(bucket + 1, 0);
+		}
+		series.present[bucket] = 1;
+		return series.values[bucket];
+	}
+
+	/**
+	* zeroes the values; the cells are marked as missing if dropPresent is set, as kept (2) otherwise
+	*/
+	static void clearSeries(std::vector<Series> &seriesList, bool dropPresent){
+		for(size_t i=0; i<seriesList.size(); ++i){
+			std::fill(seriesList[i].values.begin(), seriesList[i].values.end(), 0);
+			std::vector<char> &present = seriesList[i].present;
+			for(size_t bucket = 0; bucket < present.size(); ++bucket){
+				present[bucket] = dropPresent || !present[bucket]? 0: 2;
+			}
+			seriesList[i].realValues.clear();
+			seriesList[i].real = false;
+		}
+	}
+
+	/**
+	* true if the series exists and has at least one value
+	*/
+	bool hasData(const char *name) const{
+		std::map<std::string, SeriesId>::const_iterator it = seriesIds.find(name);
+		if(it == seriesIds.end() || (size_t)it->second >= seriesList.size()){
+			return false;
+		}
+		const std::vector<char> &present = seriesList[it->second].present;
+		return std::find(present.begin(), present.end(), 1) != present.end();
+	}
+
+	bool hasOpcounts() const{
+		std::map<std::string, SeriesId>::const_iterator it;
+		for(it = seriesIds.begin(); it != seriesIds.end(); ++it){
+			if(hasData(it->first.c_str())){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	* copies the series that have values into name -> size -> value maps for the report,
+	* whole counts into counts and floating point series into reals
+	*/
+	void collectOpcounts(OpcountMap &counts, RealMap &reals) const{
+		std::map<std::string, SeriesId>::const_iterator it;
+		for(it = seriesIds.begin(); it != seriesIds.end(); ++it){
+			if((size_t)it->second >= seriesList.size()){
+				continue;
+			}
+			const Series &series = seriesList[it->second];
+			for(size_t bucket = 0; bucket < series.values.size(); ++bucket){
+				if(!series.present[bucket]){
+					continue;
+				}
+				if(series.real){
+					reals[it->first][bucketSizes[bucket]] = series.realAt(bucket);
+				}else{
+					counts[it->first][bucketSizes[bucket]] = series.values[bucket];
+				}
+			}
+		}
+	}
+
+	/**
+	* name_IPC for the series of the hardware counters, from the summed (or divided)
+	* instructions and cycles, so that it does not depend on the number of repetitions
+	*/
+	void summarizeCounters(const OpcountMap &counts, RealMap &reals) const{
+		std::set<std::string>::const_iterator it;
+		for(it = counterNames.begin(); it != counterNames.end(); ++it){
+			RealSequence instructions, cycles;
+			collectSequence(counts, reals, *it + "_instructions", instructions);
+			collectSequence(counts, reals, *it + "_cycles", cycles);
+			RealSequence::const_iterator cit;
+			for(cit = cycles.begin(); cit != cycles.end(); ++cit){
+				RealSequence::const_iterator iit = instructions.find(cit->first);
+				if(iit != instructions.end() && cit->second > 0.0){
+					reals[*it + "_IPC"][cit->first] = iit->second / cit->second;
+				}
+			}
+		}
+	}
+
+	/**
+	* the values of series name, whether it holds counts or reals
+	*/
+	static void collectSequence(const OpcountMap &counts, const RealMap &reals, const std::string &name, RealSequence &values){
+		OpcountMap::const_iterator cit = counts.find(name);
+		if(cit != counts.end()){
+			for(OpcountSequence::const_iterator it = cit->second.begin(); it != cit->second.end(); ++it){
+				values[it->first] = (double)it->second;
+			}
+		}
+		RealMap::const_iterator rit = reals.find(name);
+		if(rit != reals.end()){
+			values.insert(rit->second.begin(), rit->second.end());
+		}
+	}
+
+	/**
+	* turns the recorded time samples into name_min, name_median and name_max sequences,
+	* grouped under name_time so they end up in the same chart
+	*/
+	void summarizeTimes(TimeMap &summary, GroupMap &reportGroups){
+		TimeSampleMap::iterator it1;
+		TimeSamples::iterator it2;
+		for(it1 = timeMap.begin(); it1 != timeMap.end(); ++it1){
+			std::string minName = it1->first + "_min";
+			std::string medianName = it1->first + "_median";
+			std::string maxName = it1->first + "_max";
+			for(it2 = it1->second.begin(); it2 != it1->second.end(); ++it2){
+				std::vector<TIME_MEASURE> &samples = it2->second;
+				size_t count = samples.size();
+				if(count == 0){
+					continue;
+				}
+				std::sort(samples.begin(), samples.end());
+				summary[minName][it2->first] = samples[0];
+				summary[maxName][it2->first] = samples[count - 1];
+				if(count % 2 == 1){
+					summary[medianName][it2->first] = samples[count / 2];
+				}else{
+					summary[medianName][it2->first] = (samples[count / 2 - 1] + samples[count / 2]) / 2;
+				}
+			}
+			std::vector<std::string> &members = reportGroups[it1->first + "_time"];
+			members.clear();
+			members.push_back(minName);
+			members.push_back(medianName);
+			members.push_back(maxName);
+		}
+	}
+
+	/**
+	* copies the samples of one size into values, as doubles
+	*/
+	template <typename Samples>
+	static void sampleValues(const Samples &samples, std::vector<double> &values){
+		values.reserve(samples.size());
+		typename Samples::const_iterator it;
+		for(it = samples.begin(); it != samples.end(); ++it){
+			values.push_back((double)*it);
+		}
+	}
+
+	/**
+	* adds the statistics of every sampled series to summary: name_mean, name_stddev, name_p5,
+	* name_p95, name_ci_low, name_ci_high and, if withMedian is set, name_median.
+	* the spread is grouped under name_spread, so the percentiles and the confidence interval
+	* show up as bands around the mean
+	*/
+	template <typename SampleMap>
+	void summarizeSamples(const SampleMap &samples, RealMap &summary, GroupMap &reportGroups, bool withMedian){
+		typename SampleMap::const_iterator it1;
+		typename SampleMap::mapped_type::const_iterator it2;
+		for(it1 = samples.begin(); it1 != samples.end(); ++it1){
+			const std::string &name = it1->first;
+			for(it2 = it1->second.begin(); it2 != it1->second.end(); ++it2){
+				std::vector<double> values;
+				sampleValues(it2->second, values);
+				if(values.empty()){
+					continue;
+				}
+				SampleSummary stats = SummarizeSamples(values);
+				summary[name + "_mean"][it2->first] = stats.mean;
+				summary[name + "_stddev"][it2->first] = stats.stddev;
+				summary[name + "_p5"][it2->first] = stats.p5;
+				summary[name + "_p95"][it2->first] = stats.p95;
+				summary[name + "_ci_low"][it2->first] = stats.ciLow;
+				summary[name + "_ci_high"][it2->first] = stats.ciHigh;
+				if(withMedian){
+					summary[name + "_median"][it2->first] = stats.median;
+				}
+			}
+			std::vector<std::string> &members = reportGroups[name + "_spread"];
+			members.clear();
+			members.push_back(name + "_p5");
+			members.push_back(name + "_ci_low");
+			members.push_back(name + "_mean");
+			members.push_back(name + "_ci_high");
+			members.push_back(name + "_p95");
+		}
+	}
+
+	void collectReport(Report &report){
+		flush();
+		report.groups = groups;
+		collectOpcounts(report.opcounts, report.reals);
+		summarizeCounters(report.opcounts, report.reals);
+		summarizeSamples(sampleMap, report.reals, report.groups, true);
+		summarizeHistograms(report.reals, report.groups);
+		summarizeTimes(report.times, report.groups);
+		summarizeSamples(timeMap, report.timeStatistics, report.groups, false);
+		collectTimeMedians(report.timeMedians);
+		report.environment = DescribeEnvironment();
+		std::map<std::string, std::string>::const_iterator it;
+		for(it = environmentNotes.begin(); it != environmentNotes.end(); ++it){
+			report.environment[it->first] = it->second;
+		}
+	}
+
+	void writeJson(FILE *fout, const Report &report){
+		bool hasSequences = false;
+
+		//first, the operation counters
+		fprintf(fout, "{\n\t\"opcount\": {\n");
+		printSequences(fout, report.opcounts, hasSequences);
+		printSequences(fout, report.reals, hasSequences);
+		if(hasSequences){
+			fprintf(fout, "\n");
+		}
+
+		//then the execution times, as min/median/max nanoseconds per size, and their spread
+		fprintf(fout, "\t},\n\t\"times\": {\n");
+		hasSequences = false;
+		printSequences(fout, report.times, hasSequences);
+		printSequences(fout, report.timeStatistics, hasSequences);
+		if(hasSequences){
+			fprintf(fout, "\n");
+		}
+
+		//next the groups
+		fprintf(fout, "\t},\n\t\"groups\": {\n");
+		GroupMap::const_iterator git1;
+		std::vector<std::string>::const_iterator git2;
+		for(git1 = report.groups.begin(); git1 != report.groups.end(); ++git1){
+			fprintf(fout, git1 != report.groups.begin()? ",\n\t\t\"": "\t\t\"");
+			print_modified(fout, git1->first.c_str());
+			fprintf(fout, "\": [");
+			for(git2 = git1->second.begin(); git2 != git1->second.end(); ++git2){
+				fprintf(fout, git2 != git1->second.begin()? ", \"": "\"");
+				print_modified(fout, git2->c_str());
+				fprintf(fout, "\"");
+			}
+			fprintf(fout, "]");
+		}
+		if(!report.groups.empty()){
+			fprintf(fout, "\n");
+		}
+
+		//and the growth model of every series
+		fprintf(fout, "\t},\n\t\"fits\": {\n");
+		hasSequences = false;
+		printFits(fout, report.opcounts, hasSequences);
+		printFits(fout, report.reals, hasSequences);
+		printFits(fout, report.timeMedians, hasSequences);
+		if(hasSequences){
+			fprintf(fout, "\n");
+		}
+
+		//last, what the numbers were measured on
+		fprintf(fout, "\t},\n\t\"environment\": {\n");
+		std::map<std::string, std::string>::const_iterator eit;
+		for(eit = report.environment.begin(); eit != report.environment.end(); ++eit){
+			fprintf(fout, eit != report.environment.begin()? ",\n\t\t": "\t\t");
+			print_string(fout, eit->first.c_str());
+			fprintf(fout, ": ");
+			print_string(fout, eit->second.c_str());
+		}
+		if(!report.environment.empty()){
+			fprintf(fout, "\n");
+		}
+		fprintf(fout, "\t}\n}\n");
+	}
+
+	void writeCsv(FILE *fout, const Report &report){
+		fprintf(fout, "section,series,size,value\n");
+		printCsv(fout, "opcount", report.opcounts);
+		printCsv(fout, "opcount", report.reals);
+		printCsv(fout, "times", report.times);
+		printCsv(fout, "times", report.timeStatistics);
+	}
+
+	template <typename SequenceMap>
+	void printCsv(FILE *fout, const char *section, const SequenceMap &sequences){
+		typename SequenceMap::const_iterator it1;
+		typename SequenceMap::mapped_type::const_iterator it2;
+		for(it1 = sequences.begin(); it1 != sequences.end(); ++it1){
+			for(it2 = it1->second.begin(); it2 != it1->second.end(); ++it2){
+				fprintf(fout, "%s,", section);
+				print_modified(fout, it1->first.c_str());
+				fprintf(fout, ",%d,", it2->first);
+				print_value(fout, it2->second);
+				fprintf(fout, "\n");
+			}
+		}
+	}
+
+	void writeBinary(FILE *fout, const Report &report){
+		fwrite("PRFB", 1, 4, fout);
+		writeBytes(fout, 1, 4);
+		writeBytes(fout, report.opcounts.size() + report.reals.size() + report.times.size() + report.timeStatistics.size(), 4);
+		printColumns(fout, 0, report.opcounts);
+		printColumns(fout, 0, report.reals);
+		printColumns(fout, 1, report.times);
+		printColumns(fout, 1, report.timeStatistics);
+	}
+
+	/**
+	* writes the lowest count bytes of value, least significant first
+	*/
+	static void writeBytes(FILE *fout, unsigned long long value, int count){
+		unsigned char bytes[8];
+		for(int i=0; i<count; ++i){
+			bytes[i] = (unsigned char)(value >> (8 * i));
+		}
+		fwrite(bytes, 1, count, fout);
+	}
+
+	static int valueType(OPCOUNT_MEASURE) { return 0; }
+	static int valueType(double) { return 1; }
+	static int valueType(TIME_MEASURE) { return 2; }
+
+	static unsigned long long valueBits(OPCOUNT_MEASURE value) { return value; }
+	static unsigned long long valueBits(TIME_MEASURE value) { return (unsigned long long)value; }
+	static unsigned long long valueBits(double value){
+		unsigned long long bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	template <typename SequenceMap>
+	void printColumns(FILE *fout, int section, const SequenceMap &sequences){
+		typename SequenceMap::const_iterator it1;
+		typename SequenceMap::mapped_type::const_iterator it2;
+		for(it1 = sequences.begin(); it1 != sequences.end(); ++it1){
+			std::string name = it1->first;
+			for(size_t i=0; i<name.size(); ++i){
+				if(!isalnum((unsigned char)name[i]) && name[i] != '_'){
+					name[i] = '_';
+				}
+			}
+			if(name.size() > 0xFFFF){
+				name.resize(0xFFFF);
+			}
+			writeBytes(fout, section, 1);
+			writeBytes(fout, valueType(typename SequenceMap::mapped_type::mapped_type()), 1);
+			writeBytes(fout, name.size(), 2);
+			fwrite(name.data(), 1, name.size(), fout);
+			writeBytes(fout, it1->second.size(), 4);
+			for(it2 = it1->second.begin(); it2 != it1->second.end(); ++it2){
+				writeBytes(fout, (unsigned int)it2->first, 4);
+			}
+			for(it2 = it1->second.begin(); it2 != it1->second.end(); ++it2){
+				writeBytes(fout, valueBits(it2->second), 8);
+			}
+		}
+	}
+
+	template <typename Run>
+	int repeatUntilStable(const char *name, int size, const StoppingRule &rule, Run run){
+		RunningStats stats;
+		Clock::time_point deadline = Clock::now() +
+			std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(rule.budgetSeconds));
+		while(stats.size() < rule.maxRepetitions){
+			stats.add(run());
+			if(stats.size() >= rule.minRepetitions &&
+					(stats.relativeWidth() <= rule.targetWidth || Clock::now() >= deadline)){
+				break;
+			}
+		}
+		countOperation((std::string(name) + "_iterations").c_str(), size, stats.size());
+		return stats.size();
+	}
+
+	/**
+	* adds the median of every timed series and size to medians, as name_median
+	*/
+	void collectTimeMedians(RealMap &medians) const{
+		TimeSampleMap::const_iterator it1;
+		TimeSamples::const_iterator it2;
+		for(it1 = timeMap.begin(); it1 != timeMap.end(); ++it1){
+			for(it2 = it1->second.begin(); it2 != it1->second.end(); ++it2){
+				if(it2->second.empty()){
+					continue;
+				}
+				std::vector<double> values;
+				sampleValues(it2->second, values);
+				std::sort(values.begin(), values.end());
+				medians[it1->first + "_median"][it2->first] = Percentile(values, 50);
+			}
+		}
+	}
+
+	template <typename Sequence>
+	static void sequenceValues(const Sequence &sequence, std::vector<double> &sizes, std::vector<double> &values){
+		typename Sequence::const_iterator it;
+		for(it = sequence.begin(); it != sequence.end(); ++it){
+			sizes.push_back((double)it->first);
+			values.push_back((double)it->second);
+		}
+	}
+
+	/**
+	* prints the fit of every sequence as "name": {"model": ..., "a": ..., ...}
+	*/
+	template <typename SequenceMap>
+	void printFits(FILE *fout, const SequenceMap &sequences, bool &hasSequences){
+		typename SequenceMap::const_iterator it;
+		for(it = sequences.begin(); it != sequences.end(); ++it){
+			std::vector<double> sizes, values;
+			sequenceValues(it->second, sizes, values);
+			CurveFit fit = FitCurve(sizes, values);
+			fprintf(fout, hasSequences? ",\n\t\t\"": "\t\t\"");
+			hasSequences = true;
+			print_modified(fout, it->first.c_str());
+			fprintf(fout, "\": {\"model\": \"%s\", \"a\": %.17g, \"b\": %.17g, \"r2\": %.17g, "
+				"\"coefficient\": %.17g, \"exponent\": %.17g, \"power_r2\": %.17g}",
+				fit.model, fit.a, fit.b, fit.r2, fit.coefficient, fit.exponent, fit.powerR2);
+		}
+	}
+
+	/**
+	* appends the samples of a thread to the merged ones and empties the thread's map
+	*/
+	template <typename SampleMap>
+	static void mergeSamples(SampleMap &merged, SampleMap &local){
+		typename SampleMap::iterator it1;
+		typename SampleMap::mapped_type::iterator it2;
+		for(it1 = local.begin(); it1 != local.end(); ++it1){
+			for(it2 = it1->second.begin(); it2 != it1->second.end(); ++it2){
+				typename SampleMap::mapped_type::mapped_type &values = merged[it1->first][it2->first];
+				values.insert(values.end(), it2->second.begin(), it2->second.end());
+			}
+		}
+		local.clear();
+	}
+
+	void print_value(FILE *f, OPCOUNT_MEASURE value){
+		fprintf(f, "%llu", value);
+	}
+
+	void print_value(FILE *f, double value){
+		fprintf(f, "%.17g", value);
+	}
+
+	void print_value(FILE *f, TIME_MEASURE value){
+		fprintf(f, "%lld", value);
+	}
+
+	/**
+	* prints every sequence of the map as "name": [[size, value], ...]
+	* hasSequences tells if a sequence was already printed in the same object,
+	* so that several maps can be printed one after another
+	*/
+	template <typename SequenceMap>
+	void printSequences(FILE *fout, const SequenceMap &sequences, bool &hasSequences){
+		typename SequenceMap::const_iterator oit1;
+		typename SequenceMap::mapped_type::const_iterator oit2;
+		for(oit1 = sequences.begin(); oit1 != sequences.end(); ++oit1){
+			fprintf(fout, hasSequences? ",\n\t\t\"": "\t\t\"");
+			hasSequences = true;
+			print_modified(fout, oit1->first.c_str());
+			fprintf(fout, "\": [");
+			for(oit2 = oit1->second.begin(); oit2 != oit1->second.end(); ++oit2){
+				if(oit2 != oit1->second.begin()){
+					fprintf(fout, ", ");
+				}
+				fprintf(fout, "[%d, ", oit2->first);
+				print_value(fout, oit2->second);
+				fprintf(fout, "]");
+			}
+			fprintf(fout, "]");
+		}
+	}
+
+	static FILE *openDescriptor(int fd){
+#ifdef _MSC_VER
+		int copy = _dup(fd);
+		FILE *fout = copy < 0? NULL: _fdopen(copy, "wb");
+#else
+		int copy = dup(fd);
+		FILE *fout = copy < 0? NULL: fdopen(copy, "wb");
+#endif
+		if(fout != NULL){
+			static const size_t BUFFER_SIZE = 1 << 16;
+			setvbuf(fout, NULL, _IOFBF, BUFFER_SIZE);
+		}
+		return fout;
+	}
+
+	/**
+	* adds the subtree of node from (in the tree of a thread) to node into of tree, matching the children by name
+	*/
+	static void mergeSpans(std::vector<SpanNode> &tree, int into, const std::vector<SpanNode> &from, int node){
+		tree[into].calls += from[node].calls;
+		tree[into].time += from[node].time;
+		tree[into].operations += from[node].operations;
+		const std::vector<int> &children = from[node].children;
+		for(size_t i=0; i<children.size(); ++i){
+			const SpanNode &child = from[children[i]];
+			int match = 0;
+			for(size_t j=0; j<tree[into].children.size(); ++j){
+				if(tree[tree[into].children[j]].name == child.name){
+					match = tree[into].children[j];
+					break;
+				}
+			}
+			if(match == 0){
+				match = (int)tree.size();
+				tree.push_back(SpanNode(child.name.c_str(), into));
+				tree[into].children.push_back(match);
+			}
+			mergeSpans(tree, match, from, children[i]);
+		}
+	}
+
+	/**
+	* the operations of node and all its children
+	*/
+	static long long totalOperations(const std::vector<SpanNode> &tree, int node){
+		long long total = tree[node].operations;
+		for(size_t i=0; i<tree[node].children.size(); ++i){
+			total += totalOperations(tree, tree[node].children[i]);
+		}
+		return total;
+	}
+
+	/**
+	* the root has no time of its own, it is the sum of the top level spans
+	*/
+	static TIME_MEASURE totalTime(const std::vector<SpanNode> &tree, int node){
+		if(node != 0){
+			return tree[node].time;
+		}
+		TIME_MEASURE total = 0;
+		for(size_t i=0; i<tree[node].children.size(); ++i){
+			total += tree[tree[node].children[i]].time;
+		}
+		return total;
+	}
+
+	void writeSpans(FILE *fout, SpanFormat format, const std::vector<SpanNode> &tree, int node, int depth, std::string &path){
+		const SpanNode &span = tree[node];
+		size_t length = path.size();
+		if(node != 0){
+			if(!path.empty()){
+				path += ';';
+			}
+			for(size_t i=0; i<span.name.size(); ++i){
+				char c = span.name[i];
+				path += (isalnum((unsigned char)c) || c == '_')? c: '_';
+			}
+			TIME_MEASURE selfTime = span.time;
+			long long operations = totalOperations(tree, node);
+			for(size_t i=0; i<span.children.size(); ++i){
+				selfTime -= tree[span.children[i]].time;
+			}
+			if(format == SPANS_TREE){
+				fprintf(fout, "%lld\t%.3f\t%.3f\t%lld\t%lld\t%*s", span.calls, span.time / 1e6, selfTime / 1e6,
+					operations, span.operations, 2 * depth, "");
+				print_modified(fout, span.name.c_str());
+				fprintf(fout, "\n");
+			}else if(format == SPANS_FOLDED && selfTime > 0){
+				fprintf(fout, "%s %lld\n", path.c_str(), (long long)selfTime);
+			}else if(format == SPANS_FOLDED_OPS && span.operations > 0){
+				fprintf(fout, "%s %lld\n", path.c_str(), span.operations);
+			}
+		}else if(format == SPANS_TREE){
+			fprintf(fout, "%lld\t%.3f\t%.3f\t%lld\t%lld\t(all)\n", 0LL, totalTime(tree, 0) / 1e6, 0.0,
+				totalOperations(tree, 0), span.operations);
+		}
+		for(size_t i=0; i<span.children.size(); ++i){
+			writeSpans(fout, format, tree, span.children[i], depth + 1, path);
+		}
+		path.resize(length);
+	}
+
+	void writeTrace(FILE *fout){
+		fprintf(fout, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+		bool first = true;
+		for(size_t i=0; i<shards.size(); ++i){
+			const std::vector<SpanEvent> &events = shards[i]->spanEvents;
+			const std::vector<SpanNode> &spans = shards[i]->spans;
+			for(size_t j=0; j<events.size(); ++j){
+				fprintf(fout, "%s\n{\"name\": \"", first? "": ",");
+				print_modified(fout, spans[events[j].node].name.c_str());
+				fprintf(fout, "\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+					(int)i + 1, events[j].start / 1e3, events[j].duration / 1e3);
+				first = false;
+			}
+		}
+		fprintf(fout, "\n]}\n");
+	}
+
+	/**
+	* str as a json string, quoted and escaped
+	*/
+	void print_string(FILE *f, const char *str){
+		fputc('"', f);
+		for(; *str; ++str){
+			if(*str == '"' || *str == '\\'){
+				fprintf(f, "\\%c", *str);
+			}else if((unsigned char)*str < 0x20){
+				fprintf(f, "\\u%04x", (unsigned char)*str);
+			}else{
+				fputc(*str, f);
+			}
+		}
+		fputc('"', f);
+	}
+
+	void print_modified(FILE *f, const char *str){
+		int i = 0;
+		while(str[i] != 0){
+			if(isalnum(str[i]) || str[i] == '_'){
+				fprintf(f, "%c", str[i]);
+			}else{
+				fprintf(f, "_");
+			}
+			++i;
 		}
 	}
 };
 
 typedef Profiler::OperationCounter Operation;
 
-enum SortMethod { UNSORTED=0, ASCENDING=1, DESCENDING=2 };
+/**
+* counter policies, so that the same algorithm builds with or without instrumentation.
+* an algorithm takes the policy as a template parameter:
+*
+*	template <typename Counter>
+*	void sort(int a[], int n, Counter &c){ ... c.compare(); ... c.assign(3); ... c.trace(a, n); }
+*
+* and is instantiated with NullCounter for the real thing (every call compiles away),
+* OpCounter to count assignments and comparisons, TimingCounter to measure the wall-clock
+* time without counting, TraceCounter to count and print the array at every step, or
+* SpanCounter to count and build the call tree of the spans (see CounterSpan)
+*/
+struct NullCounter{
+	void assign(long long = 1) {}
+	void compare(long long = 1) {}
+	template <typename T>
+	void trace(const T *, int) {}
+	void start() {}
+	void stop() {}
+	void enter(const char *) {}
+	void leave() {}
+};
+
+struct OpCounter{
+	long long assignments, comparisons;
+
+	OpCounter() : assignments(0), comparisons(0) {}
+
+	void assign(long long increment = 1) { assignments += increment; }
+	void compare(long long increment = 1) { comparisons += increment; }
+	template <typename T>
+	void trace(const T *, int) {}
+	void start() {}
+	void stop() {}
+	void enter(const char *) {}
+	void leave() {}
+
+	long long total() const { return assignments + comparisons; }
+	void reset() { assignments = comparisons = 0; }
+};
+
+struct TimingCounter : NullCounter{
+	long long elapsed;
+
+	TimingCounter() : elapsed(0) {}
+
+	void start() { begin = std::chrono::steady_clock::now(); }
+	void stop() {
+		elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - begin).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point begin;
+};
+
+/**
+* prints the array at every trace point; width > 0 prints that many elements
+* no matter how much of the array the algorithm passes (e.g. recursive calls on subarrays)
+*/
+struct TraceCounter : OpCounter{
+	int width;
+
+	TraceCounter(int printWidth = 0) : width(printWidth) {}
+
+	template <typename T>
+	void trace(const T *a, int n) {
+		if(width > 0){
+			n = width;
+		}
+		for(int i = 0; i < n; i++){
+			printElement(a[i]);
+		}
+		printf("\n");
+	}
+
+private:
+	static void printElement(int x) { printf("%d ", x); }
+	static void printElement(long long x) { printf("%lld ", x); }
+	static void printElement(double x) { printf("%g ", x); }
+};
+
+/**
+* counts like OpCounter, and also opens the spans of the algorithm in the profiler,
+* adding every operation to the innermost one (see Profiler::enterSpan)
+*/
+struct SpanCounter : OpCounter{
+	Profiler &profiler;
+
+	SpanCounter(Profiler &prof) : profiler(prof) {}
+
+	void assign(long long increment = 1) { assignments += increment; profiler.countSpan(increment); }
+	void compare(long long increment = 1) { comparisons += increment; profiler.countSpan(increment); }
+	void enter(const char *name) { profiler.enterSpan(name); }
+	void leave() { profiler.exitSpan(); }
+};
+
+/**
+* a span of the counter policy, for the scope of the object:
+*
+*	template <typename Counter>
+*	void quicksort(int a[], int l, int r, Counter &c){
+*		CounterSpan<Counter> span(c, "quicksort");
+*		...
+*	}
+*
+* with any other policy than SpanCounter it does nothing
+*/
+template <typename Counter>
+class CounterSpan{
+public:
+	CounterSpan(Counter &counter, const char *name) : c(counter) { c.enter(name); }
+	~CounterSpan() { c.leave(); }
+private:
+	Counter &c;
+	CounterSpan(const CounterSpan&);
+	CounterSpan &operator=(const CounterSpan&);
+};
+
+/**
+* xoshiro256** (Blackman, Vigna): small, fast and good enough for benchmark inputs.
+* it meets the UniformRandomBitGenerator requirements, so it also works with <random>.
+* the same seed (and stream) always gives the same sequence, on every platform
+*/
+class RandomEngine{
+public:
+	typedef unsigned long long result_type;
+
+	static const result_type DEFAULT_SEED = 0x5EED2018ULL;
+
+	static result_type min() { return 0; }
+	static result_type max() { return ~0ULL; }
+
+	explicit RandomEngine(result_type seedValue = DEFAULT_SEED, result_type stream = 0){
+		seed(seedValue, stream);
+	}
+
+	/**
+	* different streams of the same seed are independent sequences (one per thread, one per cell)
+	*/
+	void seed(result_type seedValue, result_type stream = 0){
+		result_type x = seedValue ^ (stream * 0xD1B54A32D192ED03ULL);
+		for(int i=0; i<4; ++i){
+			//splitmix64, so that similar seeds give unrelated states
+			x += 0x9E3779B97F4A7C15ULL;
+			result_type z = x;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			state[i] = z ^ (z >> 31);
+		}
+	}
+
+	result_type operator()(){
+		result_type result = rotl(state[1] * 5, 7) * 9;
+		result_type t = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 45);
+		return result;
+	}
+
+	/**
+	* uniform integer in [0, range), without the bias of % range.
+	* multiply-shift with rejection (Lemire) where 128 bit products exist, % with rejection elsewhere
+	*/
+	result_type below(result_type range){
+		if(range == 0){
+			return 0;
+		}
+#ifdef __SIZEOF_INT128__
+		unsigned __int128 product = (unsigned __int128)(*this)() * range;
+		result_type low = (result_type)product;
+		if(low < range){
+			result_type threshold = (0 - range) % range;
+			while(low < threshold){
+				product = (unsigned __int128)(*this)() * range;
+				low = (result_type)product;
+			}
+		}
+		return (result_type)(product >> 64);
+#else
+		result_type threshold = (0 - range) % range;
+		result_type x;
+		do{
+			x = (*this)();
+		}while(x < threshold);
+		return x % range;
+#endif
+	}
+
+	/**
+	* uniform integer in [low, high]
+	*/
+	long long uniform(long long low, long long high){
+		return low + (long long)below((result_type)(high - low) + 1);
+	}
+
+	/**
+	* uniform double in [0, 1)
+	*/
+	double real(){
+		return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+private:
+	result_type state[4];
+
+	static result_type rotl(result_type x, int k){
+		return (x << k) | (x >> (64 - k));
+	}
+};
+
+/**
+* the seed every thread derives its engine from, see ThreadRandom
+*/
+inline std::atomic<unsigned long long> &RandomSeedState(){
+	static std::atomic<unsigned long long> seed(RandomEngine::DEFAULT_SEED);
+	return seed;
+}
+
+inline std::atomic<unsigned long long> &RandomGeneration(){
+	static std::atomic<unsigned long long> generation(0);
+	return generation;
+}
+
+inline std::atomic<unsigned long long> &RandomThreadCount(){
+	static std::atomic<unsigned long long> count(0);
+	return count;
+}
+
+inline unsigned long long RandomSeed(){
+	return RandomSeedState().load();
+}
+
+/**
+* the engine of the calling thread, used by FillRandomArray and the other generators.
+* the n-th thread that asks for it gets stream n of the seed set with SeedRandom (a fixed
+* seed by default, so a run is reproducible; pass time(NULL) for different inputs every run).
+* SweepRunner reseeds it for every cell, so the inputs don't depend on the scheduling
+*/
+inline RandomEngine &ThreadRandom(){
+	struct LocalEngine{
+		RandomEngine engine;
+		unsigned long long generation;
+		bool seeded;
+		LocalEngine() : generation(0), seeded(false) {}
+	};
+	static thread_local LocalEngine local;
+	unsigned long long generation = RandomGeneration().load(std::memory_order_acquire);
+	if(!local.seeded || local.generation != generation){
+		local.engine.seed(RandomSeed(), RandomThreadCount()++);
+		local.generation = generation;
+		local.seeded = true;
+	}
+	return local.engine;
+}
+
+/**
+* sets the seed of every thread's engine; the calling thread gets stream 0
+*/
+inline void SeedRandom(unsigned long long seed){
+	RandomSeedState() = seed;
+	RandomThreadCount() = 0;
+	RandomGeneration()++;
+	ThreadRandom();
+}
+
+/**
+* the shape of the input made by FillRandomArray. past DESCENDING the shapes come with default
+* parameters (1% swaps, 10 distinct values, 8 teeth, Zipf exponent 1); the Fill* functions
+* below take them explicitly
+*/
+enum SortMethod { UNSORTED=0, ASCENDING=1, DESCENDING=2,
+	NEARLY_SORTED=3, FEW_UNIQUE=4, ORGAN_PIPE=5, SAWTOOTH=6, ZIPF=7, ALL_EQUAL=8 };
+
+template <typename T>
+	void FillShapedArray(T *arr, int size, T range_min, T range_max, int shape);
+
+/**
+* shuffles the array in place, every permutation being equally likely (Fisher-Yates)
+*/
+template <typename T>
+	void ShuffleArray(T *arr, int size){
+		RandomEngine &random = ThreadRandom();
+		for(int i=size-1; i>0; --i){
+			int j = (int)random.below(i + 1);
+			T aux = arr[i];
+			arr[i] = arr[j];
+			arr[j] = aux;
+		}
+	}
+
+/**
+* picks size distinct offsets from [0, range) and passes them to store(position, offset).
+* when the range is at most a few times larger than size, selection sampling (Knuth) walks it
+* and the offsets come in ascending order; otherwise Floyd's algorithm with a hash set (open
+* addressing, at most half full) takes O(size) whatever the range, in no particular order.
+* returns true if the offsets are ascending
+*/
+template <typename Store>
+	bool SampleDistinct(int size, unsigned long long range, Store store){
+		RandomEngine &random = ThreadRandom();
+		int pos = 0;
+		if(range <= 4ULL * size){
+			for(unsigned long long i=0; i<range && pos<size; ++i){
+				if(random.below(range - i) < (unsigned long long)(size - pos)){
+					store(pos++, i);
+				}
+			}
+			return true;
+		}
+		const unsigned long long EMPTY = ~0ULL;
+		int bits = 1;
+		while((1ULL << bits) < 2ULL * size){
+			++bits;
+		}
+		std::vector<unsigned long long> chosen(1ULL << bits, EMPTY);
+		size_t mask = chosen.size() - 1;
+		for(unsigned long long j = range - size; j < range; ++j){
+			unsigned long long t = random.below(j + 1);
+			size_t slot = (size_t)((t * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+			while(chosen[slot] != EMPTY && chosen[slot] != t){
+				slot = (slot + 1) & mask;
+			}
+			if(chosen[slot] == t){
+				//t was taken, but j can not have been
+				t = j;
+				slot = (size_t)((t * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+				while(chosen[slot] != EMPTY){
+					slot = (slot + 1) & mask;
+				}
+			}
+			chosen[slot] = t;
+			store(pos++, t);
+		}
+		return false;
+	}
+
+/**
+* fills arr with uniform integers from range_min to range_min + range - 1 (range < 2^32),
+* the fast path of FillRandomArray: every output of the engine gives two values, one per
+* 32 bit half (multiply-shift, with rejection so that there is no bias)
+*/
+template <typename T>
+	void FillUniformBlock(T *arr, int size, T range_min, unsigned int range){
+		RandomEngine &random = ThreadRandom();
+		unsigned int threshold = (0u - range) % range;
+		int pos = 0;
+		while(pos < size){
+			unsigned long long x = random();
+			unsigned long long low = (x & 0xFFFFFFFFULL) * range, high = (x >> 32) * range;
+			if((unsigned int)low >= threshold){
+				arr[pos++] = range_min + (T)(low >> 32);
+			}
+			if((unsigned int)high >= threshold && pos < size){
+				arr[pos++] = range_min + (T)(high >> 32);
+			}
+		}
+	}
+
+/**
+* fills arr with size uniform values from the range, already in ascending (or descending) order,
+* in O(size) instead of generating and sorting: the sorted uniforms are the partial sums of
+* size + 1 exponential spacings, divided by their total. the spacings are drawn twice from
+* the same state of the engine, the first time only to get the total, so no memory is needed
+*/
+template <typename T>
+	void FillSortedArray(T *arr, int size, T range_min, T range_max, bool descending = false){
+		bool discreteType = !(typeid(T) == typeid(double) || typeid(T) == typeid(float));
+		double interval_len = (double)range_max - (double)range_min + (discreteType? 1.0: 0.0);
+		RandomEngine &random = ThreadRandom();
+		RandomEngine start = random;
+		double total = 0.0, sum = 0.0;
+		int i;
+		for(i=0; i<=size; ++i){
+			total += -log(1.0 - random.real());
+		}
+		random = start;
+		for(i=0; i<size; ++i){
+			sum += -log(1.0 - random.real());
+			double offset = sum / total * interval_len;
+			T value;
+			if(discreteType){
+				value = range_min + (T)(long long)offset;
+				if(value > range_max){
+					value = range_max;
+				}
+			}else{
+				value = range_min + (T)offset;
+			}
+			arr[descending? size - 1 - i: i] = value;
+		}
+		//leave the engine after the last spacing, as if it had been used once
+		random.real();
+	}
+
+/**
+* sorts an array of values spread uniformly over [range_min, range_max] in O(size) expected time:
+* the values are scattered into size buckets by value, after which every value is at most a
+* bucket away from its place and one insertion sort pass finishes the job
+*/
+template <typename T>
+	void SortUniformArray(T *arr, int size, T range_min, T range_max){
+		if(size < 2){
+			return;
+		}
+		std::vector<int> next(size + 1, 0);
+		std::vector<T> scattered(size);
+		double scale = size / ((double)range_max - (double)range_min + 1.0);
+		int i, j;
+		for(i=0; i<size; ++i){
+			int bucket = (int)(((double)arr[i] - (double)range_min) * scale);
+			next[std::min(std::max(bucket, 0), size - 1) + 1]++;
+		}
+		for(i=1; i<=size; ++i){
+			next[i] += next[i - 1];
+		}
+		for(i=0; i<size; ++i){
+			int bucket = (int)(((double)arr[i] - (double)range_min) * scale);
+			scattered[next[std::min(std::max(bucket, 0), size - 1)]++] = arr[i];
+		}
+		for(i=0; i<size; ++i){
+			T value = scattered[i];
+			for(j=i; j>0 && value < arr[j - 1]; --j){
+				arr[j] = arr[j - 1];
+			}
+			arr[j] = value;
+		}
+	}
+
 /**
 * fills the given array with random elements in the given range.
-* optionally, the array can be unique or sorted in ascending (1) or descending (2) order
+* optionally, the array can be unique or sorted in ascending (1) or descending (2) order,
+* or have one of the other shapes of SortMethod (unique is ignored for those).
+* the values come from the engine of the calling thread (see ThreadRandom)
 */
 template <typename T>
 	void FillRandomArray(T *arr, int size, T range_min=10, T range_max=50000, bool unique = false, int sorted=UNSORTED){
-		int i, pos, extendedSize;
-		bool discreteType = true;
+		int i;
+		bool discreteType = true, ascending;
 		T interval_len = range_max - range_min + 1;
-		int idx1, idx2;
-		T aux;
-		static bool seeded = false;
-
-		if(!seeded){
-			srand((unsigned int)time(NULL));
-			seeded = true;
-		}
+		RandomEngine &random = ThreadRandom();
 
 		if(range_min >= range_max){
 			throw "empty range";
@@ -11356,56 +14453,310 @@ template <typename T>
 		if(typeid(T) == typeid(double) || typeid(T) == typeid(float)){
 			discreteType = false;
 		}
-		if(!unique){
+		if(sorted > DESCENDING){
+			FillShapedArray(arr, size, range_min, range_max, sorted);
+		}else if(!unique){
 			//no worries
-			for(i=0; i<size; ++i){
-				if(discreteType){
-					arr[i] = range_min + (rand() % int(interval_len));
-				}else{
-					arr[i] = range_min + ((T)(rand()) / RAND_MAX) * (interval_len - 1);
+			if(sorted != UNSORTED){
+				FillSortedArray(arr, size, range_min, range_max, sorted == DESCENDING);
+			}else if(discreteType && (unsigned long long)interval_len <= 0xFFFFFFFFULL){
+				FillUniformBlock(arr, size, range_min, (unsigned int)interval_len);
+			}else{
+				for(i=0; i<size; ++i){
+					if(discreteType){
+						arr[i] = range_min + (T)random.below((unsigned long long)interval_len);
+					}else{
+						arr[i] = range_min + (T)random.real() * (interval_len - 1);
+					}
 				}
 			}
-			if(sorted == ASCENDING){
-				std::sort(arr, arr + size);
-			}else if(sorted == DESCENDING){
-				std::sort(arr, arr + size, std::greater<T>());
-			}
 		}else{
-			//use Knuth approach
 			if(discreteType){
 				if(interval_len < size){
 					throw "range too small";
 				}
-				pos = 0;
-				for(i=0; i<=interval_len && pos<size; ++i){
-					if(rand() % (int(interval_len) - i) < (size - pos)){
-						arr[pos++] = range_min + i;
-					}
+				ascending = SampleDistinct(size, (unsigned long long)interval_len,
+					[&](int pos, unsigned long long offset) { arr[pos] = range_min + (T)offset; });
+			}else{
+				//pick distinct integers from 0 to 17*size and scale them to the range
+				unsigned long long extendedSize = 17ULL * size;
+				ascending = SampleDistinct(size, extendedSize,
+					[&](int pos, unsigned long long offset) { arr[pos] = range_min + ((T)offset / extendedSize) * (interval_len - 1); });
+			}
+			if(sorted == UNSORTED){
+				ShuffleArray(arr, size);
+			}else{
+				if(!ascending){
+					SortUniformArray(arr, size, range_min, range_max);
 				}
+				if(sorted == DESCENDING){
+					std::reverse(arr, arr + size);
+				}
+			}
+		}
+	}
+
+/**
+* sorted ascending, then swaps random pairs of elements
+*/
+template <typename T>
+	void FillNearlySorted(T *arr, int size, T range_min, T range_max, int swaps){
+		RandomEngine &random = ThreadRandom();
+		FillSortedArray(arr, size, range_min, range_max);
+		for(int k=0; k<swaps && size>1; ++k){
+			int i = (int)random.below(size), j = (int)random.below(size);
+			T aux = arr[i];
+			arr[i] = arr[j];
+			arr[j] = aux;
+		}
+	}
+
+/**
+* only distinct different values (picked at random from the range), in random order
+*/
+template <typename T>
+	void FillFewUnique(T *arr, int size, T range_min, T range_max, int distinct){
+		RandomEngine &random = ThreadRandom();
+		if(distinct > range_max - range_min + 1){
+			distinct = (int)(range_max - range_min + 1);
+		}
+		if(distinct < 1){
+			distinct = 1;
+		}
+		std::vector<T> values(distinct, range_min);
+		if(distinct > 1){
+			FillRandomArray(&values[0], distinct, range_min, range_max, true);
+		}
+		for(int i=0; i<size; ++i){
+			arr[i] = values[random.below(distinct)];
+		}
+	}
+
+/**
+* ascending up to the middle and descending after it, like a row of organ pipes
+*/
+template <typename T>
+	void FillOrganPipe(T *arr, int size, T range_min, T range_max){
+		std::vector<T> sorted(size > 0? size: 1);
+		FillSortedArray(&sorted[0], size, range_min, range_max);
+		int front = 0, back = size - 1;
+		for(int i=0; i<size; ++i){
+			if(i % 2 == 0){
+				arr[front++] = sorted[i];
 			}else{
-				//use the same approach as above, pick integers from 0 to 17*size
-				extendedSize = 17 * size;
-				pos = 0;
-				for(i=0; i<=extendedSize && pos<size; ++i){
-					if(rand() % (extendedSize - i) < (size - pos)){
-						arr[pos++] = range_min + ((T)i / extendedSize) * (interval_len - 1);
-					}
+				arr[back--] = sorted[i];
+			}
+		}
+	}
+
+/**
+* teeth ascending runs of (nearly) equal length, one after the other
+*/
+template <typename T>
+	void FillSawtooth(T *arr, int size, T range_min, T range_max, int teeth){
+		if(teeth < 1){
+			teeth = 1;
+		}
+		for(int t=0; t<teeth; ++t){
+			int begin = (int)((long long)size * t / teeth), end = (int)((long long)size * (t + 1) / teeth);
+			FillSortedArray(arr + begin, end - begin, range_min, range_max);
+		}
+	}
+
+/**
+* Zipf distributed values: range_min + k - 1 has a probability proportional to 1 / k^exponent,
+* so the small values are by far the most frequent ones. drawn in O(1) each by
+* rejection-inversion (Hormann, Derflinger), whatever the size of the range
+*/
+template <typename T>
+	void FillZipf(T *arr, int size, T range_min, T range_max, double exponent){
+		struct Zipf{
+			double s;
+			//(x^(1-s) - 1) / (1-s), the integral of h, and its inverse; log x and e^x when s = 1
+			double H(double x) const { return helper2((1.0 - s) * log(x)) * log(x); }
+			double h(double x) const { return exp(-s * log(x)); }
+			double Hinverse(double x) const{
+				double t = x * (1.0 - s);
+				if(t < -1.0){
+					t = -1.0;
 				}
+				return exp(helper1(t) * x);
 			}
-			//we got a sorted array in ascending order
-			if(sorted == DESCENDING){
-				std::reverse(arr, arr+size);
-			}else if(sorted == UNSORTED){
-				//we need to scramble the array
-				for(i=0; i<size; ++i){
-					idx1 = rand() % size;
-					idx2 = rand() % size;
-					aux = arr[idx1];
-					arr[idx1] = arr[idx2];
-					arr[idx2] = aux;
+			static double helper1(double x) { return fabs(x) > 1e-8? log(1.0 + x) / x: 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x)); }
+			static double helper2(double x) { return fabs(x) > 1e-8? (exp(x) - 1.0) / x: 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x)); }
+		};
+		RandomEngine &random = ThreadRandom();
+		double n = (double)range_max - (double)range_min + 1.0;
+		Zipf zipf;
+		zipf.s = exponent;
+		double integralFirst = zipf.H(1.5) - 1.0;
+		double integralLast = zipf.H(n + 0.5);
+		double squeeze = 2.0 - zipf.Hinverse(zipf.H(2.5) - zipf.h(2.0));
+		for(int i=0; i<size; ++i){
+			double k;
+			for(;;){
+				double u = integralLast + random.real() * (integralFirst - integralLast);
+				double x = zipf.Hinverse(u);
+				k = floor(x + 0.5);
+				if(k < 1.0){
+					k = 1.0;
+				}else if(k > n){
+					k = n;
+				}
+				if(k - x <= squeeze || u >= zipf.H(k + 0.5) - zipf.h(k)){
+					break;
 				}
 			}
+			arr[i] = range_min + (T)(k - 1.0);
+		}
+	}
+
+/**
+* every element equal to value
+*/
+template <typename T>
+	void FillAllEqual(T *arr, int size, T value){
+		for(int i=0; i<size; ++i){
+			arr[i] = value;
+		}
+	}
+
+/**
+* the shapes of SortMethod past DESCENDING, with their default parameters
+*/
+template <typename T>
+	void FillShapedArray(T *arr, int size, T range_min, T range_max, int shape){
+		switch(shape){
+			case NEARLY_SORTED: FillNearlySorted(arr, size, range_min, range_max, size / 100 > 0? size / 100: 1); break;
+			case FEW_UNIQUE: FillFewUnique(arr, size, range_min, range_max, 10); break;
+			case ORGAN_PIPE: FillOrganPipe(arr, size, range_min, range_max); break;
+			case SAWTOOTH: FillSawtooth(arr, size, range_min, range_max, 8); break;
+			case ZIPF: FillZipf(arr, size, range_min, range_max, 1.0); break;
+			case ALL_EQUAL: {
+				T value;
+				FillRandomArray(&value, 1, range_min, range_max);
+				FillAllEqual(arr, size, value);
+				break;
+			}
+			default: throw "unknown input shape";
+		}
+	}
+
+/**
+* McIlroy's adversary ("A Killer Adversary for Quicksort", 1999). every value starts as "gas",
+* larger than anything; when two gas values are compared one of them freezes into the next
+* smallest "solid" value, chosen so that the pivot candidate stays gas as long as possible.
+* running a quicksort on AdversaryItem values and reading values afterwards gives an input
+* on which the same quicksort makes about n^2 / 2 comparisons
+*/
+class QuicksortAdversary{
+public:
+	std::vector<int> values;
+
+	explicit QuicksortAdversary(int size) : values(size), gas(size), solid(0), candidate(-1){
+		for(int i=0; i<size; ++i){
+			values[i] = gas;
+		}
+		previous = current();
+		current() = this;
+	}
+
+	~QuicksortAdversary(){
+		current() = previous;
+	}
+
+	/**
+	* compares the items with indexes x and y, as a - b would
+	*/
+	int compare(int x, int y){
+		if(values[x] == gas && values[y] == gas){
+			freeze(x == candidate? x: y);
+		}
+		if(values[x] == gas){
+			candidate = x;
+		}else if(values[y] == gas){
+			candidate = y;
+		}
+		return values[x] - values[y];
+	}
+
+	/**
+	* freezes whatever the sort did not look at
+	*/
+	void finish(){
+		for(size_t i=0; i<values.size(); ++i){
+			if(values[i] == gas){
+				freeze((int)i);
+			}
+		}
+	}
+
+	static QuicksortAdversary *&current(){
+		static thread_local QuicksortAdversary *adversary = NULL;
+		return adversary;
+	}
+
+private:
+	int gas, solid, candidate;
+	QuicksortAdversary *previous;
+
+	void freeze(int x) { values[x] = solid++; }
+
+	QuicksortAdversary(const QuicksortAdversary&);
+	QuicksortAdversary &operator=(const QuicksortAdversary&);
+};
+
+/**
+* the element a quicksort is run on to build its killer input, see FillQuicksortKiller.
+* it only holds its starting position, the comparisons are answered by the adversary
+*/
+struct AdversaryItem{
+	int index;
+
+	AdversaryItem() : index(0) {}
+	AdversaryItem(int i) : index(i) {}
+
+	friend bool operator<(const AdversaryItem &a, const AdversaryItem &b) { return compare(a, b) < 0; }
+	friend bool operator>(const AdversaryItem &a, const AdversaryItem &b) { return compare(a, b) > 0; }
+	friend bool operator<=(const AdversaryItem &a, const AdversaryItem &b) { return compare(a, b) <= 0; }
+	friend bool operator>=(const AdversaryItem &a, const AdversaryItem &b) { return compare(a, b) >= 0; }
+	friend bool operator==(const AdversaryItem &a, const AdversaryItem &b) { return compare(a, b) == 0; }
+	friend bool operator!=(const AdversaryItem &a, const AdversaryItem &b) { return compare(a, b) != 0; }
+
+private:
+	static int compare(const AdversaryItem &a, const AdversaryItem &b){
+		return QuicksortAdversary::current()->compare(a.index, b.index);
+	}
+};
+
+/**
+* fills arr with a permutation of range_min .. range_min + size - 1 that drives sort to its
+* quadratic case. sort(AdversaryItem *a, int n) must sort a with the quicksort under attack:
+*
+*	FillQuicksortKiller(arr, n, [](AdversaryItem *a, int n){
+*		NullCounter c;
+*		quicksort(a, part<AdversaryItem, NullCounter>, 0, n - 1, c);
+*	});
+*
+* deterministic pivots (part, part_m) are always beaten. for a random pivot (part_rand) the
+* engine of the thread is rewound after building the input, so the next sort replays the same
+* pivots and is beaten too; any other stream of pivots just sees a random permutation
+*/
+template <typename T, typename Sort>
+	void FillQuicksortKiller(T *arr, int size, Sort sort, T range_min = 0){
+		RandomEngine &random = ThreadRandom();
+		RandomEngine start = random;
+		QuicksortAdversary adversary(size);
+		std::vector<AdversaryItem> items(size > 0? size: 1);
+		for(int i=0; i<size; ++i){
+			items[i] = AdversaryItem(i);
+		}
+		sort(&items[0], size);
+		adversary.finish();
+		for(int i=0; i<size; ++i){
+			arr[i] = range_min + (T)adversary.values[i];
 		}
+		random = start;
 	}
 
 template <typename T>
@@ -39,7 +39,7 @@ int edgecount = 0;
 
 int random(int x, int y)
 {
-    return (rand() % (y - x)) + x;
+    return (int)ThreadRandom().uniform(x, y - 1);
 }
 
 void initEdges()
@@ -363,8 +363,6 @@ void eval_BFS2()
 
 int main()
 {
-    srand(time(0));
-
     demo();
     eval_BFS1();
 
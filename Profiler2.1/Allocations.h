@@ -0,0 +1,226 @@
+#ifndef _ALLOCATIONS_H
+#define _ALLOCATIONS_H
+
+#include "Profiler.h"
+
+/**
+* allocation accounting. the translation unit with main defines PROFILER_TRACK_ALLOCATIONS
+* before including this header, which replaces the global operator new / delete and, with
+* glibc, interposes malloc, calloc, realloc and free for the whole program (so the C style
+* lists and trees of the labs are seen too). the allocations made while a scope is alive
+* are then added to the series of the scope:
+*
+*	{
+*		AllocationScope scope(p, "build_tree", n);
+*		root = build_PBT(1, n);
+*	}
+*
+* records build_tree_allocations (count), build_tree_allocated_bytes (requested bytes) and
+* build_tree_peak_bytes (the highest amount of live memory above the one at the start of
+* the scope). without the define the scopes record nothing. the counters are per thread;
+* other compilers than gcc/clang on glibc only see operator new
+*/
+struct AllocationStats{
+	long long allocations;
+	long long bytes;
+	long long live;
+	long long peak;
+};
+
+namespace AllocationHooks{
+
+	/**
+	* zero initialized and without constructor, so the allocator can use it at any time
+	*/
+	inline AllocationStats &local(){
+		static thread_local AllocationStats stats;
+		return stats;
+	}
+
+	inline bool &enabled(){
+		static bool tracking = false;
+		return tracking;
+	}
+
+	inline void allocated(size_t requested, size_t usable){
+		AllocationStats &stats = local();
+		stats.allocations++;
+		stats.bytes += requested;
+		stats.live += usable;
+		if(stats.live > stats.peak){
+			stats.peak = stats.live;
+		}
+	}
+
+	inline void released(size_t usable){
+		local().live -= usable;
+	}
+}
+
+class AllocationScope{
+public:
+	AllocationScope(Profiler &prof, const char *name, int size) : profiler(prof), series(name), inputSize(size){
+		AllocationStats &stats = AllocationHooks::local();
+		start = stats;
+		stats.peak = stats.live;
+	}
+
+	~AllocationScope(){
+		AllocationStats &stats = AllocationHooks::local();
+		AllocationStats now = stats;
+		if(start.peak > stats.peak){
+			stats.peak = start.peak;
+		}
+		if(!AllocationHooks::enabled()){
+			return;
+		}
+		//what the profiler allocates for its own bookkeeping is not part of any scope
+		AllocationStats before = stats;
+		{
+			std::string name(series);
+			profiler.countOperation((name + "_allocations").c_str(), inputSize, now.allocations - start.allocations);
+			profiler.countOperation((name + "_allocated_bytes").c_str(), inputSize, now.bytes - start.bytes);
+			profiler.countOperation((name + "_peak_bytes").c_str(), inputSize, now.peak - start.live);
+		}
+		stats = before;
+	}
+
+private:
+	Profiler &profiler;
+	const char *series;
+	int inputSize;
+	AllocationStats start;
+
+	AllocationScope(const AllocationScope&);
+	AllocationScope &operator=(const AllocationScope&);
+};
+
+#ifdef PROFILER_TRACK_ALLOCATIONS
+
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#include <errno.h>
+
+extern "C" {
+	void *__libc_malloc(size_t size);
+	void *__libc_calloc(size_t count, size_t size);
+	void *__libc_realloc(void *ptr, size_t size);
+	void *__libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void *ptr);
+
+	void *malloc(size_t size){
+		void *ptr = __libc_malloc(size);
+		if(ptr){
+			AllocationHooks::allocated(size, malloc_usable_size(ptr));
+		}
+		return ptr;
+	}
+
+	void *calloc(size_t count, size_t size){
+		void *ptr = __libc_calloc(count, size);
+		if(ptr){
+			AllocationHooks::allocated(count * size, malloc_usable_size(ptr));
+		}
+		return ptr;
+	}
+
+	void *realloc(void *ptr, size_t size){
+		size_t old = ptr? malloc_usable_size(ptr): 0;
+		void *moved = __libc_realloc(ptr, size);
+		if(moved){
+			AllocationHooks::released(old);
+			AllocationHooks::allocated(size, malloc_usable_size(moved));
+		}
+		return moved;
+	}
+
+	void *memalign(size_t alignment, size_t size){
+		void *ptr = __libc_memalign(alignment, size);
+		if(ptr){
+			AllocationHooks::allocated(size, malloc_usable_size(ptr));
+		}
+		return ptr;
+	}
+
+	void *aligned_alloc(size_t alignment, size_t size){
+		return memalign(alignment, size);
+	}
+
+	int posix_memalign(void **result, size_t alignment, size_t size){
+		void *ptr = memalign(alignment, size);
+		if(ptr == NULL){
+			return ENOMEM;
+		}
+		*result = ptr;
+		return 0;
+	}
+
+	void free(void *ptr){
+		if(ptr){
+			AllocationHooks::released(malloc_usable_size(ptr));
+		}
+		__libc_free(ptr);
+	}
+}
+
+//operator new goes through the malloc above
+void *operator new(size_t size){
+	void *ptr = malloc(size? size: 1);
+	if(ptr == NULL){
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept{
+	free(ptr);
+}
+
+#else
+
+//the size is kept in front of the block, as there is no malloc_usable_size
+static const size_t ALLOCATION_HEADER = 16;
+
+void *operator new(size_t size){
+	char *block = (char*)malloc(size + ALLOCATION_HEADER);
+	if(block == NULL){
+		throw std::bad_alloc();
+	}
+	*(size_t*)block = size;
+	AllocationHooks::allocated(size, size);
+	return block + ALLOCATION_HEADER;
+}
+
+void operator delete(void *ptr) noexcept{
+	if(ptr){
+		char *block = (char*)ptr - ALLOCATION_HEADER;
+		AllocationHooks::released(*(size_t*)block);
+		free(block);
+	}
+}
+
+#endif
+
+void *operator new[](size_t size){
+	return operator new(size);
+}
+
+void operator delete[](void *ptr) noexcept{
+	operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept{
+	operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept{
+	operator delete(ptr);
+}
+
+static bool allocationTrackingEnabled = (AllocationHooks::enabled() = true);
+
+#endif
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef _CACHE_SIM_H
+#define _CACHE_SIM_H
+
+#include "Profiler.h"
+
+/**
+* a trace driven model of the data caches and the TLB, so that the locality of an
+* algorithm can be measured without hardware counters, and the same on every machine.
+* the accesses come from Counted values (every comparison reads its operands, every
+* assignment reads the source and writes the destination) and from SimulateAccess calls
+* in hand instrumented code. a scope starts with cold caches and adds its misses to the
+* series of the scope when it goes out of scope:
+*
+*	{
+*		CacheScope cache(p, "heap_sort", n);
+*		std::make_heap(a, a + n);   // a is a Counted<int> array
+*		std::sort_heap(a, a + n);
+*	}
+*
+* records heap_sort_accesses, heap_sort_L1_misses, heap_sort_L2_misses, heap_sort_LLC_misses
+* and heap_sort_TLB_misses. scopes are per thread and can be nested, the innermost one
+* receives the accesses
+*/
+struct CacheConfig{
+	int lineSize;
+	int l1Size, l1Ways;
+	int l2Size, l2Ways;
+	int llcSize, llcWays;
+	int pageSize;
+	int tlbEntries, tlbWays;
+
+	/**
+	* a typical desktop core: 32 KiB 8-way L1, 256 KiB 8-way L2, 8 MiB 16-way LLC,
+	* 64 byte lines, 64 entry 4-way TLB over 4 KiB pages
+	*/
+	CacheConfig() : lineSize(64), l1Size(32 << 10), l1Ways(8), l2Size(256 << 10), l2Ways(8),
+		llcSize(8 << 20), llcWays(16), pageSize(4096), tlbEntries(64), tlbWays(4) {}
+};
+
+/**
+* one set associative level with LRU replacement. blocks are numbered (address / block size),
+* every set keeps its tags from the most to the least recently used
+*/
+class CacheLevel{
+public:
+	CacheLevel(int size, int blockSize, int associativity){
+		ways = associativity > 0? associativity: 1;
+		sets = size / blockSize / ways;
+		if(sets < 1){
+			sets = 1;
+		}
+		//no block number is ~0, so that marks the empty ways
+		tags.assign((size_t)sets * ways, ~0ULL);
+	}
+
+	/**
+	* looks up block, and makes it the most recently used of its set; returns false on a miss
+	*/
+	bool access(unsigned long long block){
+		unsigned long long *set = &tags[(size_t)(block % sets) * ways];
+		int i = 0;
+		while(i < ways - 1 && set[i] != block){
+			++i;
+		}
+		bool hit = set[i] == block;
+		for(; i > 0; --i){
+			set[i] = set[i - 1];
+		}
+		set[0] = block;
+		return hit;
+	}
+
+private:
+	std::vector<unsigned long long> tags;
+	unsigned long long sets;
+	int ways;
+};
+
+class CacheSim{
+public:
+	long long accesses;
+	long long l1Misses, l2Misses, llcMisses;
+	long long tlbMisses;
+
+	CacheSim(const CacheConfig &config = CacheConfig())
+		: accesses(0), l1Misses(0), l2Misses(0), llcMisses(0), tlbMisses(0),
+		  lineSize(config.lineSize), pageSize(config.pageSize),
+		  l1(config.l1Size, config.lineSize, config.l1Ways),
+		  l2(config.l2Size, config.lineSize, config.l2Ways),
+		  llc(config.llcSize, config.lineSize, config.llcWays),
+		  tlb(config.tlbEntries * config.pageSize, config.pageSize, config.tlbWays) {}
+
+	/**
+	* simulates an access to bytes bytes at address; an access that straddles
+	* two lines counts as one access to each
+	*/
+	void access(const void *address, size_t bytes){
+		unsigned long long first = (unsigned long long)(size_t)address / lineSize;
+		unsigned long long last = ((unsigned long long)(size_t)address + (bytes? bytes: 1) - 1) / lineSize;
+		for(unsigned long long line = first; line <= last; ++line){
+			accesses++;
+			if(!tlb.access(line * lineSize / pageSize)){
+				tlbMisses++;
+			}
+			if(l1.access(line)){
+				continue;
+			}
+			l1Misses++;
+			if(l2.access(line)){
+				continue;
+			}
+			l2Misses++;
+			if(!llc.access(line)){
+				llcMisses++;
+			}
+		}
+	}
+
+	/**
+	* the simulator of the calling thread, NULL if accesses are not being simulated
+	*/
+	static CacheSim *&current(){
+		static thread_local CacheSim *sim = NULL;
+		return sim;
+	}
+
+private:
+	unsigned long long lineSize, pageSize;
+	CacheLevel l1, l2, llc, tlb;
+};
+
+/**
+* feeds an access of hand instrumented code to the simulator of the calling thread, if any
+*/
+inline void SimulateAccess(const void *address, size_t bytes){
+	CacheSim *sim = CacheSim::current();
+	if(sim){
+		sim->access(address, bytes);
+	}
+}
+
+class CacheScope{
+public:
+	CacheScope(Profiler &prof, const char *name, int size, const CacheConfig &config = CacheConfig())
+		: sim(config), profiler(prof), series(name), inputSize(size){
+		previous = CacheSim::current();
+		CacheSim::current() = &sim;
+	}
+
+	~CacheScope(){
+		CacheSim::current() = previous;
+		std::string name(series);
+		profiler.countOperation((name + "_accesses").c_str(), inputSize, sim.accesses);
+		profiler.countOperation((name + "_L1_misses").c_str(), inputSize, sim.l1Misses);
+		profiler.countOperation((name + "_L2_misses").c_str(), inputSize, sim.l2Misses);
+		profiler.countOperation((name + "_LLC_misses").c_str(), inputSize, sim.llcMisses);
+		profiler.countOperation((name + "_TLB_misses").c_str(), inputSize, sim.tlbMisses);
+	}
+
+	CacheSim sim;
+
+private:
+	Profiler &profiler;
+	const char *series;
+	int inputSize;
+	CacheSim *previous;
+
+	CacheScope(const CacheScope&);
+	CacheScope &operator=(const CacheScope&);
+};
+
+#endif
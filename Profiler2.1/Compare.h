@@ -0,0 +1,439 @@
+#ifndef _COMPARE_H
+#define _COMPARE_H
+
+#include "Profiler.h"
+
+/**
+* loads the results written by Profiler::exportResults (JSON, CSV or binary) or embedded
+* in a report-*.html file, and compares two of them series by series:
+*
+*	ResultSet baseline, current;
+*	LoadResults("baseline.csv", baseline);
+*	LoadResults("report-QuickSort-20181212-202344.html", current);
+*	std::vector<SeriesChange> changes = CompareResults(baseline, current, 0.05);
+*
+* larger values are taken as worse (operation counts, times, misses). besides the values,
+* the growth of every series is compared: both are fitted (FitCurve) on the sizes they share,
+* and a series whose power law exponent grows regresses too
+*/
+typedef std::map<int, double> ResultSequence;
+typedef std::map<std::string, ResultSequence> ResultSection;
+typedef std::map<std::string, ResultSection> ResultSet;
+
+namespace ResultFormats{
+
+	inline void skipSpaces(const char *&p){
+		while(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'){
+			++p;
+		}
+	}
+
+	inline bool readString(const char *&p, std::string &value){
+		skipSpaces(p);
+		if(*p != '"'){
+			return false;
+		}
+		value.clear();
+		for(++p; *p && *p != '"'; ++p){
+			if(*p == '\\' && p[1]){
+				++p;
+			}
+			value += *p;
+		}
+		if(*p != '"'){
+			return false;
+		}
+		++p;
+		return true;
+	}
+
+	inline bool readNumber(const char *&p, double &value){
+		skipSpaces(p);
+		char *end;
+		value = strtod(p, &end);
+		if(end == p){
+			return false;
+		}
+		p = end;
+		return true;
+	}
+
+	inline bool expect(const char *&p, char c){
+		skipSpaces(p);
+		if(*p != c){
+			return false;
+		}
+		++p;
+		return true;
+	}
+
+	/**
+	* skips any json value (the groups, the fits)
+	*/
+	inline bool skipValue(const char *&p){
+		std::string text;
+		skipSpaces(p);
+		if(*p == '"'){
+			return readString(p, text);
+		}
+		if(*p == '{' || *p == '['){
+			int depth = 0;
+			for(; *p; ++p){
+				if(*p == '"'){
+					if(!readString(p, text)){
+						return false;
+					}
+					--p;
+				}else if(*p == '{' || *p == '['){
+					++depth;
+				}else if(*p == '}' || *p == ']'){
+					if(--depth == 0){
+						++p;
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+		while(*p && *p != ',' && *p != '}' && *p != ']'){
+			++p;
+		}
+		return true;
+	}
+
+	/**
+	* reads {"name": [[size, value], ...], ...} into section
+	*/
+	inline bool readSection(const char *&p, ResultSection &section){
+		if(!expect(p, '{')){
+			return false;
+		}
+		skipSpaces(p);
+		if(*p == '}'){
+			++p;
+			return true;
+		}
+		do{
+			std::string name;
+			if(!readString(p, name) || !expect(p, ':') || !expect(p, '[')){
+				return false;
+			}
+			ResultSequence &sequence = section[name];
+			skipSpaces(p);
+			if(*p == ']'){
+				++p;
+				continue;
+			}
+			do{
+				double size, value;
+				if(!expect(p, '[') || !readNumber(p, size) || !expect(p, ',') || !readNumber(p, value) || !expect(p, ']')){
+					return false;
+				}
+				sequence[(int)size] = value;
+			}while(expect(p, ','));
+			if(!expect(p, ']')){
+				return false;
+			}
+		}while(expect(p, ','));
+		return expect(p, '}');
+	}
+
+	inline bool parseJson(const char *p, ResultSet &results){
+		if(!expect(p, '{')){
+			return false;
+		}
+		do{
+			std::string key;
+			if(!readString(p, key) || !expect(p, ':')){
+				return false;
+			}
+			if(key == "opcount" || key == "times"){
+				if(!readSection(p, results[key])){
+					return false;
+				}
+			}else if(!skipValue(p)){
+				return false;
+			}
+		}while(expect(p, ','));
+		return expect(p, '}');
+	}
+
+	inline bool parseCsv(const std::string &text, ResultSet &results){
+		size_t start = text.find('\n');
+		while(start != std::string::npos && start + 1 < text.size()){
+			size_t end = text.find('\n', start + 1);
+			std::string line = text.substr(start + 1, end == std::string::npos? std::string::npos: end - start - 1);
+			start = end;
+			size_t c1 = line.find(','), c2 = line.find(',', c1 + 1), c3 = line.find(',', c2 + 1);
+			if(line.empty() || line == "\r"){
+				continue;
+			}
+			if(c1 == std::string::npos || c2 == std::string::npos || c3 == std::string::npos){
+				return false;
+			}
+			std::string section = line.substr(0, c1);
+			std::string name = line.substr(c1 + 1, c2 - c1 - 1);
+			results[section][name][atoi(line.c_str() + c2 + 1)] = strtod(line.c_str() + c3 + 1, NULL);
+		}
+		return true;
+	}
+
+	inline unsigned long long readBytes(const unsigned char *&p, int count){
+		unsigned long long value = 0;
+		for(int i=0; i<count; ++i){
+			value |= (unsigned long long)p[i] << (8 * i);
+		}
+		p += count;
+		return value;
+	}
+
+	inline bool parseBinary(const std::string &text, ResultSet &results){
+		const unsigned char *p = (const unsigned char*)text.data() + 4;
+		const unsigned char *end = (const unsigned char*)text.data() + text.size();
+		if(end - p < 8 || readBytes(p, 4) != 1){
+			return false;
+		}
+		unsigned long long seriesCount = readBytes(p, 4);
+		for(unsigned long long s=0; s<seriesCount; ++s){
+			if(end - p < 4){
+				return false;
+			}
+			int section = (int)readBytes(p, 1);
+			int type = (int)readBytes(p, 1);
+			size_t nameLength = (size_t)readBytes(p, 2);
+			if((size_t)(end - p) < nameLength + 4){
+				return false;
+			}
+			std::string name((const char*)p, nameLength);
+			p += nameLength;
+			size_t count = (size_t)readBytes(p, 4);
+			if((size_t)(end - p) < count * 12){
+				return false;
+			}
+			ResultSequence &sequence = results[section == 0? "opcount": "times"][name];
+			const unsigned char *values = p + 4 * count;
+			for(size_t i=0; i<count; ++i){
+				int size = (int)(unsigned int)readBytes(p, 4);
+				unsigned long long bits = readBytes(values, 8);
+				double value;
+				if(type == 1){
+					memcpy(&value, &bits, sizeof(value));
+				}else if(type == 2){
+					value = (double)(long long)bits;
+				}else{
+					value = (double)bits;
+				}
+				sequence[size] = value;
+			}
+			p = values;
+		}
+		return true;
+	}
+}
+
+/**
+* loads a result set, the format is told by the content of the file.
+* returns false if the file can not be read or is not a result set
+*/
+inline bool LoadResults(const char *fileName, ResultSet &results){
+	FILE *fin = fopen(fileName, "rb");
+	if(fin == NULL){
+		return false;
+	}
+	std::string text;
+	char buffer[1 << 16];
+	size_t count;
+	while((count = fread(buffer, 1, sizeof(buffer), fin)) > 0){
+		text.append(buffer, count);
+	}
+	fclose(fin);
+
+	results.clear();
+	if(text.compare(0, 4, "PRFB") == 0){
+		return ResultFormats::parseBinary(text, results);
+	}
+	if(text.compare(0, 7, "section") == 0){
+		return ResultFormats::parseCsv(text, results);
+	}
+	size_t start = text.find("var data = ");
+	if(start != std::string::npos){
+		start += strlen("var data = ");
+	}else{
+		start = 0;
+	}
+	return ResultFormats::parseJson(text.c_str() + start, results);
+}
+
+/**
+* the change of one series between two result sets.
+* a point (size) is significant if the confidence intervals of the two runs do not overlap;
+* series without an interval (exact counts) are significant whenever they changed, except
+* for times, which are not gated without an interval (a single sample has no significance).
+* change is the mean relative change over all the points both runs have, the points that
+* did not change significantly counting as 0, so that one outlier size does not decide it.
+* the growth models are the best fits of the two runs (empty below MIN_FIT_POINTS sizes)
+*/
+struct SeriesChange{
+	std::string section, name;
+	int points, significantPoints;
+	double change;
+	double worstChange;
+	int worstSize;
+	std::string modelBefore, modelAfter;
+	double exponentBefore, exponentAfter;
+	bool growthRegressed;
+	bool gated;
+	bool regressed;
+};
+
+/**
+* the least number of shared sizes for comparing the growth of a series
+*/
+static const int MIN_FIT_POINTS = 4;
+
+/**
+* the order of a model of FitCurve, from "1" (0) to "n^3" (5)
+*/
+inline int GrowthRank(const std::string &model){
+	static const char *models[] = { "1", "log n", "n", "n log n", "n^2", "n^3" };
+	for(int i=0; i<(int)(sizeof(models)/sizeof(models[0])); ++i){
+		if(model == models[i]){
+			return i;
+		}
+	}
+	return 0;
+}
+
+/**
+* true for the series that only describe the spread of another one
+* (and IPC, where larger is better, and the repetition counts of the adaptive runs, which
+* follow the noise of the machine); they are compared but never fail the gate
+*/
+inline bool IsSpreadSeries(const std::string &name){
+	static const char *suffixes[] = { "_ci_low", "_ci_high", "_p5", "_p95", "_stddev", "_min", "_max", "_IPC",
+		"_iterations" };
+	for(size_t i=0; i<sizeof(suffixes)/sizeof(suffixes[0]); ++i){
+		size_t length = strlen(suffixes[i]);
+		if(name.size() > length && name.compare(name.size() - length, length, suffixes[i]) == 0){
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+* the confidence interval of series name at size, looked up as <stem>_ci_low and <stem>_ci_high
+* where stem is name without its _mean or _median suffix
+*/
+inline bool FindInterval(const ResultSection &section, const std::string &name, int size, double &low, double &high){
+	std::string stem = name;
+	static const char *suffixes[] = { "_mean", "_median" };
+	for(size_t i=0; i<sizeof(suffixes)/sizeof(suffixes[0]); ++i){
+		size_t length = strlen(suffixes[i]);
+		if(stem.size() > length && stem.compare(stem.size() - length, length, suffixes[i]) == 0){
+			stem.resize(stem.size() - length);
+			break;
+		}
+	}
+	ResultSection::const_iterator lowIt = section.find(stem + "_ci_low");
+	ResultSection::const_iterator highIt = section.find(stem + "_ci_high");
+	if(lowIt == section.end() || highIt == section.end()){
+		return false;
+	}
+	ResultSequence::const_iterator l = lowIt->second.find(size), h = highIt->second.find(size);
+	if(l == lowIt->second.end() || h == highIt->second.end()){
+		return false;
+	}
+	low = l->second;
+	high = h->second;
+	return true;
+}
+
+/**
+* compares every series present in both sets, on the sizes present in both.
+* a gated series regresses when its change is above threshold (0.05 = 5% worse), or
+* when its growth gets worse: the power law exponent grows by more than exponentThreshold,
+* or the best model is of a higher order and the exponent grows by half that. (a higher
+* order alone is a tie between two neighbouring models, e.g. n and n log n, and a run
+* of noise can break it either way)
+*/
+inline std::vector<SeriesChange> CompareResults(const ResultSet &baseline, const ResultSet &current, double threshold,
+		double exponentThreshold = 0.1){
+	std::vector<SeriesChange> changes;
+	ResultSet::const_iterator sit;
+	ResultSection::const_iterator it;
+	ResultSequence::const_iterator pit;
+	for(sit = baseline.begin(); sit != baseline.end(); ++sit){
+		ResultSet::const_iterator other = current.find(sit->first);
+		if(other == current.end()){
+			continue;
+		}
+		for(it = sit->second.begin(); it != sit->second.end(); ++it){
+			ResultSection::const_iterator match = other->second.find(it->first);
+			if(match == other->second.end()){
+				continue;
+			}
+			SeriesChange c;
+			c.section = sit->first;
+			c.name = it->first;
+			c.points = c.significantPoints = 0;
+			c.change = c.worstChange = 0.0;
+			c.worstSize = 0;
+			c.exponentBefore = c.exponentAfter = 0.0;
+			c.growthRegressed = false;
+			c.gated = !IsSpreadSeries(it->first);
+			bool hasInterval = false;
+			std::vector<double> sizes, valuesBefore, valuesAfter;
+			for(pit = it->second.begin(); pit != it->second.end(); ++pit){
+				ResultSequence::const_iterator cur = match->second.find(pit->first);
+				if(cur == match->second.end()){
+					continue;
+				}
+				c.points++;
+				double before = pit->second, after = cur->second;
+				sizes.push_back(pit->first);
+				valuesBefore.push_back(before);
+				valuesAfter.push_back(after);
+				double lowBefore, highBefore, lowAfter, highAfter;
+				if(FindInterval(sit->second, it->first, pit->first, lowBefore, highBefore) &&
+						FindInterval(other->second, it->first, pit->first, lowAfter, highAfter)){
+					hasInterval = true;
+					if(lowAfter <= highBefore && lowBefore <= highAfter){
+						continue;
+					}
+				}else if(before == after){
+					continue;
+				}
+				double relative = before != 0.0? (after - before) / fabs(before): (after > 0.0? HUGE_VAL: -HUGE_VAL);
+				c.significantPoints++;
+				c.change += relative;
+				if(c.significantPoints == 1 || relative > c.worstChange){
+					c.worstChange = relative;
+					c.worstSize = pit->first;
+				}
+			}
+			if(c.points == 0){
+				continue;
+			}
+			c.change /= c.points;
+			if(c.section == "times" && !hasInterval){
+				c.gated = false;
+			}
+			if((int)sizes.size() >= MIN_FIT_POINTS){
+				CurveFit before = FitCurve(sizes, valuesBefore), after = FitCurve(sizes, valuesAfter);
+				c.modelBefore = before.model;
+				c.modelAfter = after.model;
+				c.exponentBefore = before.exponent;
+				c.exponentAfter = after.exponent;
+				double rise = after.exponent - before.exponent;
+				c.growthRegressed = rise > exponentThreshold ||
+					(GrowthRank(c.modelAfter) > GrowthRank(c.modelBefore) && rise > exponentThreshold / 2);
+			}
+			c.regressed = c.gated && (c.change > threshold || c.growthRegressed);
+			changes.push_back(c);
+		}
+	}
+	return changes;
+}
+
+#endif
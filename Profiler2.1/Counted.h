@@ -0,0 +1,169 @@
+#ifndef _COUNTED_H
+#define _COUNTED_H
+
+#include "Profiler.h"
+#include "CacheSim.h"
+
+/**
+* collects the operations done on Counted values by the calling thread and adds them
+* to the given profiler series when it goes out of scope:
+*
+*	{
+*		CountedSink sink(p, "sort_comparisons", "sort_assignments", n);
+*		sort(a, a + n); // a is a Counted<int> array
+*	}
+*
+* sinks can be nested, the innermost one receives the counts
+*/
+class CountedSink{
+public:
+	long long comparisons, assignments;
+
+	CountedSink(Profiler &prof, const char *comparisonSeries, const char *assignmentSeries, int size)
+		: comparisons(0), assignments(0), profiler(prof), inputSize(size){
+		comparisonId = profiler.seriesId(comparisonSeries);
+		assignmentId = profiler.seriesId(assignmentSeries);
+		previous = current();
+		current() = this;
+	}
+
+	~CountedSink(){
+		current() = previous;
+		profiler.countOperation(comparisonId, inputSize, comparisons);
+		profiler.countOperation(assignmentId, inputSize, assignments);
+	}
+
+	/**
+	* the sink of the calling thread, NULL if operations are not being counted
+	*/
+	static CountedSink *&current(){
+		static thread_local CountedSink *sink = NULL;
+		return sink;
+	}
+
+private:
+	Profiler &profiler;
+	Profiler::SeriesId comparisonId, assignmentId;
+	int inputSize;
+	CountedSink *previous;
+
+	CountedSink(const CountedSink&);
+	CountedSink &operator=(const CountedSink&);
+};
+
+/**
+* a value that counts every comparison and every copy, move or assignment made to it,
+* so that a generic algorithm instantiated with Counted<T> reports exact counts without
+* hand written ops += ... lines. a swap costs 3 assignments, as in the labs.
+* there is no implicit conversion back to T, so no comparison can slip by uncounted;
+* use get() to read the value. inside a CacheScope the same operations are also fed to
+* the cache simulator, as reads of the operands and writes of the destination
+*/
+template <typename T>
+class Counted{
+public:
+	Counted() : value() {}
+	Counted(const T &v) : value(v) { assigned(this); }
+	Counted(const Counted &other) : value(other.value) { assigned(this, &other); }
+
+	Counted &operator=(const Counted &other){
+		value = other.value;
+		assigned(this, &other);
+		return *this;
+	}
+
+	Counted &operator=(const T &v){
+		value = v;
+		assigned(this);
+		return *this;
+	}
+
+	const T &get() const { return value; }
+
+	friend bool operator<(const Counted &a, const Counted &b) { compared(&a, &b); return a.value < b.value; }
+	friend bool operator>(const Counted &a, const Counted &b) { compared(&a, &b); return a.value > b.value; }
+	friend bool operator<=(const Counted &a, const Counted &b) { compared(&a, &b); return a.value <= b.value; }
+	friend bool operator>=(const Counted &a, const Counted &b) { compared(&a, &b); return a.value >= b.value; }
+	friend bool operator==(const Counted &a, const Counted &b) { compared(&a, &b); return a.value == b.value; }
+	friend bool operator!=(const Counted &a, const Counted &b) { compared(&a, &b); return a.value != b.value; }
+
+	friend bool operator<(const Counted &a, const T &b) { compared(&a); return a.value < b; }
+	friend bool operator>(const Counted &a, const T &b) { compared(&a); return a.value > b; }
+	friend bool operator<=(const Counted &a, const T &b) { compared(&a); return a.value <= b; }
+	friend bool operator>=(const Counted &a, const T &b) { compared(&a); return a.value >= b; }
+	friend bool operator==(const Counted &a, const T &b) { compared(&a); return a.value == b; }
+	friend bool operator!=(const Counted &a, const T &b) { compared(&a); return a.value != b; }
+
+	friend bool operator<(const T &a, const Counted &b) { compared(&b); return a < b.value; }
+	friend bool operator>(const T &a, const Counted &b) { compared(&b); return a > b.value; }
+	friend bool operator<=(const T &a, const Counted &b) { compared(&b); return a <= b.value; }
+	friend bool operator>=(const T &a, const Counted &b) { compared(&b); return a >= b.value; }
+	friend bool operator==(const T &a, const Counted &b) { compared(&b); return a == b.value; }
+	friend bool operator!=(const T &a, const Counted &b) { compared(&b); return a != b.value; }
+
+	friend void swap(Counted &a, Counted &b){
+		T aux = a.value;
+		a.value = b.value;
+		b.value = aux;
+		CountedSink *sink = CountedSink::current();
+		if(sink){
+			sink->assignments += 3;
+		}
+		CacheSim *sim = CacheSim::current();
+		if(sim){
+			sim->access(&a, sizeof(a));
+			sim->access(&b, sizeof(b));
+			sim->access(&a, sizeof(a));
+			sim->access(&b, sizeof(b));
+		}
+	}
+
+private:
+	T value;
+
+	static void compared(const Counted *a, const Counted *b = NULL){
+		CountedSink *sink = CountedSink::current();
+		if(sink){
+			sink->comparisons++;
+		}
+		CacheSim *sim = CacheSim::current();
+		if(sim){
+			sim->access(a, sizeof(*a));
+			if(b){
+				sim->access(b, sizeof(*b));
+			}
+		}
+	}
+
+	static void assigned(const Counted *destination, const Counted *source = NULL){
+		CountedSink *sink = CountedSink::current();
+		if(sink){
+			sink->assignments++;
+		}
+		CacheSim *sim = CacheSim::current();
+		if(sim){
+			if(source){
+				sim->access(source, sizeof(*source));
+			}
+			sim->access(destination, sizeof(*destination));
+		}
+	}
+};
+
+/**
+* copies a plain array into a Counted one, without counting (the input is not part of the measurement)
+*/
+template <typename T>
+	void CopyArray(Counted<T> *dst, const T *src, int size){
+		CountedSink *sink = CountedSink::current();
+		CacheSim *sim = CacheSim::current();
+		CountedSink::current() = NULL;
+		CacheSim::current() = NULL;
+		for(int i=0; i<size; ++i){
+			dst[i] = src[i];
+		}
+		CountedSink::current() = sink;
+		CacheSim::current() = sim;
+	}
+
+#endif
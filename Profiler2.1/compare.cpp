@@ -0,0 +1,72 @@
+/**
+* compares two result sets and fails when a series got slower:
+*
+*	compare [-t percent] [-e exponent] [-v] baseline current
+*
+* baseline and current are files written by Profiler::exportResults (JSON, CSV or binary)
+* or report-*.html files. every series found in both is compared on the sizes found in both;
+* -t sets the regression threshold (5% by default), -e the largest rise of the power law
+* exponent of a series (0.1), -v also lists the unchanged series.
+* the exit code is 0 if nothing regressed, 1 if a series regressed and 2 on errors
+*/
+#include "Compare.h"
+
+static int usage(const char *program){
+	fprintf(stderr, "usage: %s [-t percent] [-e exponent] [-v] baseline current\n", program);
+	return 2;
+}
+
+int main(int argc, char *argv[]){
+	double threshold = 5.0, exponentThreshold = 0.1;
+	bool verbose = false;
+	const char *files[2] = { NULL, NULL };
+	int fileCount = 0;
+	for(int i=1; i<argc; ++i){
+		if(strcmp(argv[i], "-t") == 0 && i + 1 < argc){
+			threshold = atof(argv[++i]);
+		}else if(strcmp(argv[i], "-e") == 0 && i + 1 < argc){
+			exponentThreshold = atof(argv[++i]);
+		}else if(strcmp(argv[i], "-v") == 0){
+			verbose = true;
+		}else if(argv[i][0] != '-' && fileCount < 2){
+			files[fileCount++] = argv[i];
+		}else{
+			return usage(argv[0]);
+		}
+	}
+	if(fileCount != 2){
+		return usage(argv[0]);
+	}
+
+	ResultSet baseline, current;
+	for(int i=0; i<2; ++i){
+		if(!LoadResults(files[i], i == 0? baseline: current)){
+			fprintf(stderr, "%s: can not read results from %s\n", argv[0], files[i]);
+			return 2;
+		}
+	}
+
+	std::vector<SeriesChange> changes = CompareResults(baseline, current, threshold / 100.0, exponentThreshold);
+	int regressions = 0;
+	for(size_t i=0; i<changes.size(); ++i){
+		const SeriesChange &c = changes[i];
+		if(c.regressed){
+			++regressions;
+		}
+		bool growthChanged = c.modelBefore != c.modelAfter || c.growthRegressed;
+		if(!verbose && c.significantPoints == 0 && !growthChanged){
+			continue;
+		}
+		printf("%-10s %-8s %-40s %+8.2f%%  worst %+8.2f%% at %d  (%d/%d sizes changed)\n",
+			c.regressed? "REGRESSED": (c.change < 0? "improved": (c.significantPoints > 0? "changed": "same")),
+			c.section.c_str(), c.name.c_str(), 100.0 * c.change, 100.0 * c.worstChange, c.worstSize,
+			c.significantPoints, c.points);
+		if(growthChanged || (verbose && !c.modelBefore.empty())){
+			printf("%-10s %-8s %-40s growth %s -> %s, n^%.3f -> n^%.3f\n", c.regressed && c.growthRegressed? "REGRESSED": "",
+				c.section.c_str(), c.name.c_str(), c.modelBefore.c_str(), c.modelAfter.c_str(),
+				c.exponentBefore, c.exponentAfter);
+		}
+	}
+	printf("%d series compared, %d regressed by more than %.2f%% or in growth\n", (int)changes.size(), regressions, threshold);
+	return regressions > 0? 1: 0;
+}
@@ -1,4 +1,6 @@
 #include "Profiler.h"
+#include "Counted.h"
+#include "CacheSim.h"
 
 #define MAX_SIZE 2000
 
@@ -60,6 +62,42 @@ bool hasDuplicates(int *v, int size){
 	return dup;
 }
 
+/**
+* the library sorts know nothing about the profiler, the Counted values do the counting
+* (and feed the cache simulator)
+*/
+void countSorts(int *v, int size){
+	Counted<int> a[MAX_SIZE];
+
+	CopyArray(a, v, size);
+	{
+		CountedSink sink(profiler, "std_sort_comp", "std_sort_assign", size);
+		CacheScope cache(profiler, "std_sort", size);
+		std::sort(a, a + size);
+	}
+
+	CopyArray(a, v, size);
+	{
+		CountedSink sink(profiler, "heap_sort_comp", "heap_sort_assign", size);
+		CacheScope cache(profiler, "heap_sort", size);
+		std::make_heap(a, a + size);
+		std::sort_heap(a, a + size);
+	}
+
+	//the hardware counters (where the kernel allows them), on plain ints
+	int b[MAX_SIZE];
+	CopyArray(b, v, size);
+	profiler.startCounters("std_sort", size);
+	std::sort(b, b + size);
+	profiler.stopCounters("std_sort", size);
+
+	CopyArray(b, v, size);
+	profiler.startCounters("heap_sort", size);
+	std::make_heap(b, b + size);
+	std::sort_heap(b, b + size);
+	profiler.stopCounters("heap_sort", size);
+}
+
 int main(void){
 	//compute some powers of 5
 	printf("Computing powers...\n");
@@ -86,6 +124,17 @@ int main(void){
 		hasDuplicates(v, n); //we're not actually interested in the result
 	}
 
+	profiler.reset("demo-counted");
+	//third example: count the operations of generic algorithms
+	printf("Counting library sorts...\n");
+	for(n=100; n<MAX_SIZE; n += 100){
+		countSorts(v, n);
+	}
+	profiler.createGroup("comparisons", "std_sort_comp", "heap_sort_comp");
+	profiler.createGroup("assignments", "std_sort_assign", "heap_sort_assign");
+	profiler.createGroup("L1_misses", "std_sort_L1_misses", "heap_sort_L1_misses");
+	profiler.createGroup("IPC", "std_sort_IPC", "heap_sort_IPC");
+
 	profiler.showReport();
 	return 0;
 }